@@ -0,0 +1,540 @@
+/****************************************************************************
+ *
+ *  rart.cpp
+ *  The rart command line tool
+ *
+ *  Trains ART, ARTMAP and TopoART networks on CSV or binary matrix files
+ *  and predicts with them, without R. The models are saved in the binary
+ *  model format, so they can be loaded in R with loadModel and vice versa.
+ *
+ *    rart train [options] data model
+ *    rart predict [options] model data
+ *    rart compact [options] model out
+ *    rart convert in out
+ *
+ ****************************************************************************/
+
+#include <iostream>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+#include <cstdlib>
+#include <cmath>
+#include <stdexcept>
+#include "core.h"
+#include "core-io.h"
+#include "core-model.h"
+#include "core-progress.h"
+#include "core-stream.h"
+
+namespace {
+
+  const char *USAGE =
+    "Usage:\n"
+    "  rart train [options] <data> <model>\n"
+    "  rart predict [options] <model> <data>\n"
+    "  rart compact [options] <model> <out>\n"
+    "  rart convert [options] <in> <out>\n"
+    "\n"
+    "Data files are CSV (.csv, .txt) or binary matrix files (any other extension).\n"
+    "\n"
+    "Train options:\n"
+    "  --type art|artmap|topoart   the network type (art)\n"
+    "  --rule fuzzy|hypersphere|ART1\n"
+    "                              the learning rule (fuzzy)\n"
+    "  --modules n                 the number of modules (1, or 2 for topoart)\n"
+    "  --vigilance v               the vigilance of module 0 (0.7)\n"
+    "  --learning-rate b           the learning rate (1.0)\n"
+    "  --learning-rate2 b          topoart: the learning rate of the sbm node (0.6)\n"
+    "  --tau n                     topoart: the node removal cycle (100)\n"
+    "  --phi n                     topoart: the counter threshold (6)\n"
+    "  --capacity n                the number of categories to allocate at a time\n"
+    "  --max-epochs n              the maximum number of epochs\n"
+    "  --changed-fraction f        stop when less than this fraction of the categories\n"
+    "                              changed in an epoch\n"
+    "  --weight-delta e            stop when the weights moved by less than this in an epoch\n"
+    "  --stable-epochs k           stop when the number of categories has not grown for k\n"
+    "                              epochs\n"
+    "  --labels file               artmap: the labels, one column (simplified) or the\n"
+    "                              target matrix (with --standard). Without it, the\n"
+    "                              last column(s) of the data file are the target.\n"
+    "  --standard                  artmap: use the standard map field\n"
+    "  --staged                    topoart: learn each module on its own thread\n"
+    "  --active-set                art: search each row from its category of the last epoch\n"
+    "  --shards n                  art: train on n shards of the rows in parallel and merge\n"
+    "                              their categories; the data is read into memory\n"
+    "  --batch                     art: batch epochs; the rows of each batch are assigned\n"
+    "                              in parallel and the categories updated after it. The\n"
+    "                              data is read into memory.\n"
+    "  --batch-size n              art: the rows per batch, 0 for the whole epoch (10000)\n"
+    "  --speculative               art: search the rows of a window in parallel and learn\n"
+    "                              them in order; the result is the same as without it\n"
+    "  --window n                  art: the rows per window of --speculative (128 per thread)\n"
+    "  --deferred                  art: train module 0 alone, then each upper module on the\n"
+    "                              categories of the module below it\n"
+    "  --threads n                 art: the number of threads to train the shards, the\n"
+    "                              batch epochs, the speculative windows or the deferred\n"
+    "                              modules with (all the cores)\n"
+    "  --compare                   art: also train serially and compare with the shards\n"
+    "  --chunk-size n              the number of rows to read at a time; the data file\n"
+    "                              is streamed from disk for every epoch (10000). Not\n"
+    "                              with --shards or --batch.\n"
+    "  --stats                     print the counters of the category search to stderr\n"
+    "  --progress file             append the progress of each epoch to the file as JSON\n"
+    "                              lines (/dev/stderr to watch it)\n"
+    "  --progress-interval s       the minimum seconds between progress reports; the last\n"
+    "                              epoch is always reported (1)\n"
+    "\n"
+    "Predict options:\n"
+    "  --module id                 art and topoart: the module to classify with (0)\n"
+    "  --hierarchy                 art: classify from the top module down, searching each\n"
+    "                              module only under the best categories of the module\n"
+    "                              above; prints the category of every module and whether\n"
+    "                              module 0 was searched in full\n"
+    "  --width n                   art: with --hierarchy, the categories of each module with\n"
+    "                              the highest activations to search under (16)\n"
+    "  --labels file               artmap: test the predictions against the labels\n"
+    "  --output file               write the predictions to a CSV file (stdout)\n"
+    "  --ranges file               normalize the data with the column ranges in the file\n"
+    "  --stats                     print the counters of the category search to stderr\n"
+    "\n"
+    "Compact options:\n"
+    "  --min-counter k             remove the categories with a counter below k, for\n"
+    "                              topoart an accumulator n below k (2)\n"
+    "  --data file                 predict the rows before and after to report the\n"
+    "                              agreement and the time\n"
+    "  --labels file               artmap: test the predictions against the labels\n"
+    "  --relearn                   learn the rows of the removed categories by the kept\n"
+    "                              categories they resonate with\n"
+    "  --order                     order the categories kept by their usage, the most\n"
+    "                              used first (with --min-counter 0, only reorder)\n"
+    "  --ranges file               normalize the data with the column ranges in the file\n"
+    "\n"
+    "Convert options:\n"
+    "  --normalize                 scale each column to [0, 1] by its minimum and maximum\n"
+    "  --ranges file               normalize with the column ranges in the file instead\n"
+    "  --save-ranges file          write the column ranges used to a CSV file\n"
+    "  --threads n                 the number of threads to parse and normalize with\n"
+    "                              (all the cores)\n";
+
+  /* Options: the --name value pairs and the positional arguments of a command */
+  struct Options {
+    std::map< std::string, std::string > values;
+    std::vector< std::string > args;
+
+    bool has( const std::string &name ) const { return values.count( name ) > 0; }
+
+    std::string get( const std::string &name, const std::string &otherwise ) const {
+      std::map< std::string, std::string >::const_iterator i = values.find( name );
+      return i == values.end() ? otherwise : i->second;
+    }
+
+    double number( const std::string &name, double otherwise ) const {
+      if ( !has( name ) ){
+        return otherwise;
+      }
+      char *end;
+      std::string v = get( name, "" );
+      double x = std::strtod( v.c_str(), &end );
+      if ( v.empty() || *end != '\0' ){
+        throw std::invalid_argument( "The value of --" + name + " must be a number." );
+      }
+      return x;
+    }
+  };
+
+  Options parse( int argc, char **argv, int first ){
+    // the options that take no value
+    static const char *flags[] = { "standard", "staged", "normalize", "stats", "active-set", "compare", "batch", "speculative", "hierarchy", "deferred", "relearn", "order" };
+
+    Options o;
+    for ( int i = first; i < argc; i++ ){
+      std::string a = argv[i];
+      if ( a.compare( 0, 2, "--" ) != 0 ){
+        o.args.push_back( a );
+        continue;
+      }
+      std::string name = a.substr( 2 );
+      bool flag = false;
+      for ( const char *f : flags ){
+        flag = flag || name == f;
+      }
+      if ( flag ){
+        o.values[name] = "1";
+      }
+      else if ( i + 1 < argc ){
+        o.values[name] = argv[++i];
+      }
+      else{
+        throw std::invalid_argument( "The option " + a + " needs a value." );
+      }
+    }
+    return o;
+  }
+
+  void checkArgs( const Options &o, size_t n ){
+    if ( o.args.size() != n ){
+      throw std::invalid_argument( "Wrong number of arguments." );
+    }
+  }
+
+  // readRanges: the column ranges written by --save-ranges, the minimum in the first row and the
+  // maximum in the second
+  void readRanges( const std::string &file, std::vector< double > &minimum, std::vector< double > &maximum ){
+    core::Matrix r = core::readData( file );
+    if ( r.rows != 2 ){
+      throw std::invalid_argument( "The ranges file " + file + " must have two rows, the minimum and the maximum." );
+    }
+    minimum.assign( r.values.begin(), r.values.begin() + r.cols );
+    maximum.assign( r.values.begin() + r.cols, r.values.end() );
+  }
+
+  // readInput: read a data file, normalized with the ranges of --ranges if it is given
+  core::Matrix readInput( const Options &o, const std::string &file ){
+    if ( !o.has( "ranges" ) ){
+      return core::readData( file );
+    }
+    std::vector< double > minimum, maximum;
+    readRanges( o.get( "ranges", "" ), minimum, maximum );
+    return core::readNormalized( file, minimum, maximum, o.number( "threads", 0 ) );
+  }
+
+  // printStats: the search counters, one line per module
+  void printStats( const core::Stats &stats ){
+    std::cerr << stats.rows << " rows in " << stats.time << " s" << std::endl;
+    for ( size_t id = 0; id < stats.modules.size(); id++ ){
+      const core::ModuleStats &m = stats.modules[id];
+      double candidates = 0;
+      for ( size_t d = 0; d < m.depth.size(); d++ ){
+        candidates += d * m.depth[d];
+      }
+      std::cerr << "Module " << id << ": " << m.searches << " searches, "
+                << ( m.searches > 0 ? candidates/m.searches : 0 ) << " candidates per search, "
+                << m.vigilanceFailures << " vigilance failures, " << m.matchTrackingResets << " match tracking resets, "
+                << m.newCategories << " new categories, " << m.removals << " removals; ";
+      if ( m.blocksVisited > 0 ){
+        std::cerr << "blocks " << m.blocksVisited << " visited, " << m.blocksMatchPruned << " pruned by match, "
+                  << m.blocksActivationPruned << " pruned by activation; ";
+      }
+      std::cerr << "activation " << m.activationTime << " s, search " << m.searchTime << " s, update "
+                << m.updateTime << " s" << std::endl;
+    }
+  }
+
+  // printShards: the result of sharded training, compared with serial training if it was
+  void printShards( const core::ShardReport &r ){
+    std::cerr << r.shards << " shards: " << r.shardCategories << " categories in " << r.shardTime
+              << " s, merged into " << r.categories << " in " << r.mergeTime << " s" << std::endl;
+    if ( r.compared ){
+      std::cerr << "Serial: " << r.serialCategories << " categories in " << r.serialTime
+                << " s; adjusted Rand index " << r.agreement << std::endl;
+    }
+  }
+
+  int train( const Options &o ){
+    checkArgs( o, 2 );
+    std::string type = o.get( "type", "art" );
+    core::Rule rule = core::parseRule( o.get( "rule", "fuzzy" ) );
+    double vigilance = o.number( "vigilance", 0.7 );
+    double learningRate = o.number( "learning-rate", 1.0 );
+    int chunkSize = o.number( "chunk-size", 10000 );
+    core::Stats stats;
+    core::Stats *counters = o.has( "stats" ) ? &stats : NULL;
+    std::unique_ptr< core::ProgressSink > progress;
+    core::Convergence convergence;
+    convergence.changedFraction = o.number( "changed-fraction", 0 );
+    convergence.weightDelta = o.number( "weight-delta", 0 );
+    convergence.stableEpochs = o.number( "stable-epochs", 0 );
+    if ( o.has( "progress" ) ){
+      progress.reset( new core::JSONLinesSink( o.get( "progress", "" ), o.number( "progress-interval", 1 ) ) );
+    }
+
+    core::Network net;
+    if ( type == "art" && o.has( "shards" ) + o.has( "batch" ) + o.has( "speculative" ) + o.has( "active-set" ) +
+                          o.has( "deferred" ) > 1 ){
+      throw std::invalid_argument( "Only one of --shards, --batch, --speculative, --active-set and --deferred can be used." );
+    }
+    if ( type == "art" && ( o.has( "shards" ) || o.has( "batch" ) ) ){
+      if ( o.has( "chunk-size" ) ){
+        throw std::invalid_argument( "--chunk-size cannot be used with --shards or --batch, which read the data into memory." );
+      }
+      core::Matrix data = core::readData( o.args[0] );
+      net = core::ART::create( rule, data.cols, o.number( "modules", 1 ), vigilance, learningRate,
+                               o.number( "capacity", 100 ), o.number( "max-epochs", 10 ) );
+      core::initR_bar( net, data.view() );
+      core::ART::init( net );
+      net.stats = counters;
+      net.progress = progress.get();
+      net.convergence = convergence;
+      if ( o.has( "batch" ) ){
+        core::ART::trainBatch( net, data.view(), o.number( "batch-size", 10000 ), o.number( "threads", 0 ) );
+      }
+      else{
+        printShards( core::ART::trainSharded( net, data.view(), o.number( "shards", 1 ), o.number( "threads", 0 ),
+                                              o.has( "compare" ) ) );
+      }
+    }
+    else if ( type == "art" ){
+      core::FileStream data( o.args[0], chunkSize );
+      net = core::ART::create( rule, data.cols(), o.number( "modules", 1 ), vigilance, learningRate,
+                               o.number( "capacity", 100 ), o.number( "max-epochs", 10 ) );
+      core::initR_bar( net, data );
+      core::ART::init( net );
+      net.stats = counters;
+      net.progress = progress.get();
+      net.convergence = convergence;
+      if ( o.has( "deferred" ) ){
+        core::ART::trainDeferred( net, data, o.number( "threads", 0 ) );
+      }
+      else if ( o.has( "speculative" ) ){
+        core::ART::trainSpeculative( net, data, o.number( "window", 0 ), o.number( "threads", 0 ) );
+      }
+      else{
+        core::ART::train( net, data, o.has( "active-set" ) );
+      }
+    }
+    else if ( type == "artmap" ){
+      bool simplified = !o.has( "standard" );
+      if ( o.has( "labels" ) ){
+        // separate label files are read into memory
+        core::Matrix data = core::readData( o.args[0] );
+        core::Matrix labels = core::readData( o.get( "labels", "" ) );
+        net = core::ARTMAP::create( rule, data.cols, vigilance, learningRate, o.number( "capacity", 100 ),
+                                    o.number( "max-epochs", 10 ), simplified );
+        core::initR_bar( net, data.view() );
+        core::ARTMAP::init( net );
+        net.stats = counters;
+        net.progress = progress.get();
+        net.convergence = convergence;
+        core::ARTMAP::train( net, data.view(), labels.view() );
+      }
+      else{
+        // the last column is the label; the standard map field takes half of the columns as the target
+        int cols = core::openRows( o.args[0] )->cols();
+        if ( !simplified && cols % 2 != 0 ){
+          throw std::invalid_argument( "The data file must have as many target columns as data columns." );
+        }
+        core::FileStream data( o.args[0], chunkSize, simplified ? 1 : cols/2 );
+        net = core::ARTMAP::create( rule, data.cols(), vigilance, learningRate, o.number( "capacity", 100 ),
+                                    o.number( "max-epochs", 10 ), simplified );
+        core::initR_bar( net, data );
+        core::ARTMAP::init( net );
+        net.stats = counters;
+        net.progress = progress.get();
+        net.convergence = convergence;
+        core::ARTMAP::train( net, data );
+      }
+    }
+    else if ( type == "topoart" ){
+      core::FileStream data( o.args[0], chunkSize );
+      net = core::Topo::create( rule, data.cols(), o.number( "modules", 2 ), vigilance, learningRate,
+                                o.number( "learning-rate2", 0.6 ), o.number( "tau", 100 ), o.number( "phi", 6 ),
+                                o.number( "capacity", 200 ), o.number( "max-epochs", 20 ) );
+      core::initR_bar( net, data );
+      core::Topo::init( net );
+      net.stats = counters;
+      net.progress = progress.get();
+      net.convergence = convergence;
+      core::Topo::train( net, data, o.has( "staged" ) );
+    }
+    else{
+      throw std::invalid_argument( "Unknown network type " + type + "." );
+    }
+
+    core::saveNetwork( net, o.args[1] );
+    std::cerr << "Stopped after epoch " << ( net.stopReason == core::STOP_MAX_EPOCHS ? net.maxEpochs : net.epochs )
+              << ": " << core::stopReasonName( net.stopReason ) << std::endl;
+    for ( const core::Module &module : net.modules ){
+      std::cerr << "Module " << module.id << ": " << module.numCategories << " categories" << std::endl;
+    }
+    if ( counters != NULL ){
+      printStats( stats );
+    }
+    return 0;
+  }
+
+  int predict( const Options &o ){
+    checkArgs( o, 2 );
+    core::Network net = core::loadNetwork( o.args[0] );
+    core::Matrix data = readInput( o, o.args[1] );
+    core::Rows x = data.view();
+    int id = o.number( "module", 0 );
+    core::Stats stats;
+    if ( o.has( "stats" ) ){
+      net.stats = &stats;
+    }
+
+    std::vector< std::string > names;
+    std::vector< double > out;
+    int cols;
+    if ( net.type == core::NETWORK_ART && o.has( "hierarchy" ) ){
+      core::ART::HierarchyPrediction p = core::ART::predictHierarchy( net, x, o.number( "width", 16 ) );
+      names.push_back( "category" );
+      for ( int m = 1; m < p.modules; m++ ){
+        names.push_back( "category" + std::to_string( m ) );
+      }
+      names.push_back( "fallback" );
+      for ( int i = 0; i < x.rows; i++ ){
+        for ( int m = 0; m < p.modules; m++ ){
+          int c = p.path[(size_t)i * p.modules + m];
+          out.push_back( c == -1 ? NAN : c );
+        }
+        out.push_back( p.fallback[i] );
+      }
+    }
+    else if ( net.type == core::NETWORK_ART ){
+      std::vector< int > category = core::ART::predict( net, id, x );
+      names.push_back( "category" );
+      for ( int c : category ){
+        out.push_back( c == -1 ? NAN : c );
+      }
+    }
+    else if ( net.type == core::NETWORK_TOPOART ){
+      std::vector< int > category, linkedCluster;
+      core::Topo::predict( net, id, x, category, linkedCluster );
+      names.push_back( "category" );
+      names.push_back( "linkedCluster" );
+      for ( size_t i = 0; i < category.size(); i++ ){
+        out.push_back( category[i] == -1 ? NAN : category[i] );
+        out.push_back( linkedCluster[i] == -1 ? NAN : linkedCluster[i] );
+      }
+    }
+    else{
+      core::Matrix labels;
+      if ( o.has( "labels" ) ){
+        labels = core::readData( o.get( "labels", "" ) );
+      }
+      core::ARTMAP::Prediction p = core::ARTMAP::predict( net, x, labels.view() );
+      for ( int j = 0; j < p.predictedDimension; j++ ){
+        names.push_back( p.predictedDimension == 1 ? "predicted" : "predicted" + std::to_string( j + 1 ) );
+      }
+      names.push_back( "category_a" );
+      if ( labels.rows > 0 ){
+        names.push_back( "matched" );
+      }
+      for ( int i = 0; i < x.rows; i++ ){
+        out.insert( out.end(), p.predicted.begin() + (size_t)i * p.predictedDimension,
+                    p.predicted.begin() + (size_t)( i + 1 ) * p.predictedDimension );
+        out.push_back( p.category_a[i] == -1 ? NAN : p.category_a[i] );
+        if ( labels.rows > 0 ){
+          out.push_back( p.matched[i] );
+        }
+      }
+    }
+
+    cols = names.size();
+    core::writeCSV( o.get( "output", "/dev/stdout" ), core::Rows( out.data(), out.size()/cols, cols ), names );
+    if ( net.stats != NULL ){
+      printStats( stats );
+      // predicting only reads the weights, so they are still viewed in the model file
+      for ( const core::Module &module : net.modules ){
+        std::cerr << "Module " << module.id << " weights: " << ( module.w.viewed() ? "mapped" : "copied" ) << std::endl;
+      }
+    }
+    return 0;
+  }
+
+  int compact( const Options &o ){
+    checkArgs( o, 2 );
+    core::Network net = core::loadNetwork( o.args[0] );
+    core::Matrix data, labels;
+    if ( o.has( "data" ) ){
+      data = readInput( o, o.get( "data", "" ) );
+    }
+    if ( o.has( "labels" ) ){
+      labels = core::readData( o.get( "labels", "" ) );
+    }
+    core::CompactReport r = core::compact( net, o.number( "min-counter", 2 ), data.view(), labels.view(),
+                                           o.has( "relearn" ), o.has( "order" ) );
+    core::saveNetwork( net, o.args[1] );
+
+    for ( size_t id = 0; id < r.categories.size(); id++ ){
+      std::cerr << "Module " << id << ": " << r.categories[id] << " categories, " << r.removed[id] << " removed";
+      if ( o.has( "order" ) ){
+        // the most used categories that learned 80% of the rows
+        std::vector< int > usage = core::categoryUsage( net, net.modules[id] );
+        long total = 0, sum = 0;
+        for ( int u : usage ){
+          total += u;
+        }
+        int k = 0;
+        while ( k < (int)usage.size() && sum < 0.8 * total ){
+          sum += usage[k++];
+        }
+        std::cerr << "; the first " << k << " learned 80% of the rows";
+      }
+      std::cerr << std::endl;
+    }
+    if ( r.measured ){
+      std::cerr << data.rows << " rows: " << r.orphans << " in removed categories, " << r.relearned
+                << " relearned; " << r.agreement << " keep their category" << std::endl;
+      if ( r.tested ){
+        std::cerr << "Accuracy " << r.accuracyBefore << " before, " << r.accuracyAfter << " after" << std::endl;
+      }
+      std::cerr << "Predicted in " << r.timeBefore << " s before, " << r.timeAfter << " s after" << std::endl;
+    }
+    return 0;
+  }
+
+  int convert( const Options &o ){
+    checkArgs( o, 2 );
+    core::Matrix m;
+    if ( o.has( "normalize" ) || o.has( "ranges" ) ){
+      std::vector< double > minimum, maximum;
+      if ( o.has( "ranges" ) ){
+        readRanges( o.get( "ranges", "" ), minimum, maximum );
+      }
+      core::NormalizedData d = core::readNormalized( o.args[0], minimum, maximum, o.number( "threads", 0 ) );
+      if ( o.has( "save-ranges" ) ){
+        std::vector< double > ranges( d.minimum );
+        ranges.insert( ranges.end(), d.maximum.begin(), d.maximum.end() );
+        core::writeCSV( o.get( "save-ranges", "" ), core::Rows( ranges.data(), 2, d.cols ), d.names );
+      }
+      m = d;
+    }
+    else{
+      m = core::readData( o.args[0] );
+    }
+    if ( core::isCSV( o.args[1] ) ){
+      core::writeCSV( o.args[1], m.view(), m.names );
+    }
+    else{
+      core::writeMatrix( o.args[1], m.view() );
+    }
+    return 0;
+  }
+}
+
+int main( int argc, char **argv ){
+  if ( argc < 2 ){
+    std::cerr << USAGE;
+    return 2;
+  }
+  std::string command = argv[1];
+  try {
+    Options o = parse( argc, argv, 2 );
+    if ( command == "train" ){
+      return train( o );
+    }
+    if ( command == "predict" ){
+      return predict( o );
+    }
+    if ( command == "compact" ){
+      return compact( o );
+    }
+    if ( command == "convert" ){
+      return convert( o );
+    }
+    if ( command == "help" || command == "--help" ){
+      std::cout << USAGE;
+      return 0;
+    }
+    std::cerr << "Unknown command " << command << ".\n" << USAGE;
+    return 2;
+  }
+  catch ( const std::exception &e ){
+    std::cerr << "rart: " << e.what() << std::endl;
+    return 1;
+  }
+}
@@ -7,10 +7,10 @@
 
 
 #include <Rcpp.h>
-#include "utils.h"
-#include "fuzzy.h"
-#include "hypersphere.h"
-#include "art1.h"
+#include <chrono>
+#include "core.h"
+#include "native.h"
+#include "core-stream.h"
 using namespace Rcpp;
 
 
@@ -26,8 +26,8 @@ namespace ART {
                                 _["weightDimension"] = 0,       // the number of dimensions in the weight
                                 _["capacity"] = categorySize,   // number of category to create when the module runs out of categories to match
                                 _["numCategories"] = 0,         // number of categories created during learning
-                                _["alpha"] = 0.001,             // activation function parameter
-                                _["epsilon"] = 0.000001,        // match function parameter
+                                _["alpha"] = core::ALPHA,       // activation function parameter
+                                _["epsilon"] = core::EPSILON,   // match function parameter
                                 _["w"] = w,                     // top-down weights
                                 _["rho"] = vigilance,           // vigilance parameter
                                 _["beta"] = learningRate,       // learning parameter
@@ -40,19 +40,6 @@ namespace ART {
     return module;
   }
   
-  // rho: If there is just one module, then return the rho as is. If there are more than
-  // one module in the hierarchy, then the next module in the hierarchy will have 
-  // rho = 0.5*(rho + 1) with rho being the vigilance value of the previous module.
-  double rho ( double rho, int moduleId ){
-    
-    for ( int i = 1; i <= moduleId; i++ ){
-      rho = rho*2 - 1;
-      //rho = 0.5*( rho + 1 );
-    }
-    
-    return rho;
-  }
-  
   List create ( int dimension, int num = 1, double vigilance = 0.75, double learningRate = 1.0, int categorySize = 100, int maxEpochs = 20 ){
     if ( vigilance < 0.0 || vigilance > 1.0 ){
       stop( "The vigilance value must be between 0 and 1.0." );
@@ -82,14 +69,14 @@ namespace ART {
     List modules;
     for ( int i = 0; i < num; i++ ){
       if ( i > 0 ){
-        vigilance = ART::rho( vigilance, i );
+        vigilance = core::ART::rho( vigilance, i );
       }
       if ( vigilance > 0 ){
         modules.push_back( ART::module( i, vigilance, learningRate, categorySize ) );
       }
       else{
         net["numModules"] = as<int>( net["numModules"] ) - 1;
-        std::cout << "Module Id " << i << " cannot be created because its vigilance will be 0 or negative." << std::endl;
+        Rcout << "Module Id " << i << " cannot be created because its vigilance will be 0 or negative." << std::endl;
       }
     }
     
@@ -107,30 +94,12 @@ namespace ART {
     return net["dimension"];
   }
   
-  int getJmax( List module, int matchIndex = 0 ){
-    return as<IntegerVector>( module["Jmax"] )[matchIndex];
-  }
-  
-  void setJmax( List module, int J, int matchIndex = 0 ){
-    IntegerVector v = module["Jmax"];
-    v[matchIndex] = J;
-    module["Jmax"] = v;
-  }
-  
   void addJmax( List module, int J ){
     IntegerVector v = module["Jmax"];
     v.push_back( J );
     module["Jmax"] = v;
   }
   
-  int getMaxEpochs( List net ){
-    return net["maxEpochs"];
-  }
-  
-  void setEpoch( List net, int epoch ){
-    net["epochs"] = epoch;
-  }
-  
   int getNumModules( List net ){
     return net["numModules"];
   }
@@ -143,422 +112,196 @@ namespace ART {
     as<List>( net["module"] )[getID( module )] = module;
   }
   
-  bool hasMoreModules( List net, int currentModuleID ){
-    return ( currentModuleID+1 ) < ART::getNumModules( net ); 
-  }
-  
-  List nextModule( List net ){
-    int numModules = getNumModules( net );
-    if ( hasMoreModules ( net, net["activeModule"] ) ){
-      return getModule( net, as<int>( net["activeModule"] ) + 1 );
-    }
-    return NULL;
-  }
-  
-  void incChange( List module, int index ){
-    as<IntegerVector>( module["change"] )[index]++;
-  }
-  
-  int getModuleChange( List module ){
-    return sum( as<IntegerVector>( module["change"] ) );
-  }
-
-  int getTotalChange( List net ){
-    int n = getNumModules( net );
-    int s = 0;
-    for ( int i = 0; i < n; i++ ){
-      List module = getModule( net, i );
-      s += getModuleChange( module );
-    }
-    return s;
-  }
-
-  IntegerVector getChangeVector( List module ){
-    return module["change"];
-  }
-  
-  void setChangeVector( List module, IntegerVector v ){
-    module["change"] = v;
-  }
-  
-  void changeReset( List module ){
-    IntegerVector c = as<IntegerVector>( module["change"] );
-    int l = c.length();
-    for ( int i = 0; i < l; i++ ){
-      c( i ) = 0;
-    }
-    
-    module["change"] = c;
-  }
-
-  int getCapacity( List module ){
-    return module["capacity"];
-  }
-  
-  NumericMatrix getWeightMatrix( List module ){
-    return module["w"];
-  }
-  void setWeightMatrix( List module, NumericMatrix w ){
-    module["w"] = w;
-  }
-
   int getWeightDimension( List module ){
     return module["weightDimension"];
   }
-
-  void setWeightDimension( List module, int dimension ){
-    module["weightDimension"] = dimension;
-  }
-  
-  NumericVector getWeight( List module, int weightIndex ) {
-    return getWeightMatrix( module )( weightIndex, _ );
-  }
-  void setWeight( List module, int weightIndex, NumericVector w ) {
-    NumericMatrix wm = as<NumericMatrix>( module["w"] );
-    wm( weightIndex, _ ) = w;
-  }
-  
-  double getRho( List module ) {
-    return module["rho"];
-  }
-  void setRho( List module, double rho ) {
-    module["rho"] = rho;
-  }
-  
-  int getNumCategories( List module ){
-    return module["numCategories"];
-  }
-  
-  void setNumCategories( List module, int x ){
-    module["numCategories"] = x;
-  }
   
   double getLearningRate( List module ){
     return module["beta"];
   }
   
-  void setLearningRate( List module, double learningRate ){
-    module["beta"] = learningRate;
-  }
-  
-  int getCounter( List module, int weightIndex ){
-    return as<IntegerVector>( module["counter"] )( weightIndex );
-  }
-  
-  IntegerVector getCounterVector( List module ){
-    return module["counter"];
-  }
-  
-  void counterUpdate ( List module, int nodeIndex ){
-    IntegerVector n = as<IntegerVector>( module["counter"] );
-    n( nodeIndex ) = n( nodeIndex ) + 1;
-    
-    module["counter"] = n;
-  }
-  
-  void counterReset ( List module ){
-    IntegerVector n = as<IntegerVector>( module["counter"] );
-    int l = n.length();
-    for ( int i = 0; i < l; i++ ){
-      n( i ) = 0;
-    }
-    
-    module["counter"] = n;
-  }
-  
-  void setCounterVector( List module, IntegerVector v ){
-    module["counter"] = v;
-  }
-  
   double getAlpha( List module ){
     return module["alpha"];
   }
   
-  double getEpsilon( List module ){
-    return module["epsilon"];
-  }
-  
-  void initModule( List module, int weightDimension ){
-    int size = ART::getCapacity( module );
-    setWeightDimension( module, weightDimension );
-    
-    NumericMatrix w = no_init( size, weightDimension );
-    setWeightMatrix( module, w );
-    
-    IntegerVector n( size );
-    setCounterVector( module, n);
-    
-    IntegerVector c(size);
-    setChangeVector( module, c );
-  }
-  
-  void init( IModel &model ){
-    int n = ART::getNumModules( model.net );
-    for ( int i = 0; i < n; i++ ){
-      List module = ART::getModule( model.net, i );
-      initModule( module, model.getWeightDimension( getDimension( model.net ) ) );
-    }
-    model.net["init"] = 1;
-  }
-
   bool isInitialized( List net ){
     return net["init"];
   }
-  
-  NumericVector activation( IModel &model, List module, NumericVector x ){
-    
-    int nc = getNumCategories( module );
-    NumericVector a( nc );
-    
-    for ( int k = 0; k < nc; k++ ){
-      NumericVector w = getWeight( module, k );
-      a[k] = model.activation( module, x, w );
-    }
-    
-    return a;
+
+}
+
+// [[Rcpp::export(.trainART)]]
+List train ( List net, NumericMatrix x, bool stats = false, RObject progress = R_NilValue, double progressInterval = 1,
+             Nullable< List > convergence = R_NilValue, bool activeSet = false, bool batch = false,
+             int batchSize = 10000, bool speculative = false, int threads = 0, bool deferred = false ){
+  if ( activeSet + batch + speculative + deferred > 1 ){
+    stop( "Only one of activeSet, batch, speculative and deferred can be used." );
   }
-  
-  double match( IModel &model, List module, int weightIndex, NumericVector x ){
-    NumericVector w = getWeight( module, weightIndex );
-    double a = model.match( module, x, w );
-    return a;
+  core::Network state = native::toNetwork( net );
+  core::Stats counters;
+  if ( stats ){
+    state.stats = &counters;
   }
+  std::unique_ptr< core::ProgressSink > sink = native::progressSink( progress, progressInterval );
+  state.progress = sink.get();
+  state.convergence = native::toConvergence( convergence );
+  std::vector< double > rows = native::rowMajor( x );
+  core::Rows data( rows.data(), x.nrow(), x.ncol() );
   
-  void weightUpdate( IModel &model, List module, int weightIndex, NumericVector x ){
-    
-    NumericVector w_old = getWeight( module, weightIndex );
-    NumericVector w_new = model.weightUpdate( module, getLearningRate( module ), x, w_old );
-    setWeight( module, weightIndex, w_new );
-    double s = sum( abs ( w_old - w_new ) );
-    if ( s > 0.0000001 ){
-      incChange( module, weightIndex );
-    }
-    
+  core::initR_bar( state, data );
+  if ( !state.initialized ) {
+    core::ART::init( state );
   }
-  
-  void newCategory( IModel &model, List module, NumericVector x ){
-    
-    int numCategories = getNumCategories( module );
-    int newCategoryIndex = numCategories;
-    NumericMatrix wm = getWeightMatrix( module );
-    if ( numCategories == wm.rows() ){
-      // reached the max capacity, so add more rows
-      NumericMatrix newWeight = appendRows( wm, getCapacity( module ) );
-      setWeightMatrix( module, newWeight );
-    }
-    if ( numCategories == getCounterVector( module ).length() ){  
-      IntegerVector n = appendVector( getCounterVector( module ), getCapacity( module ) );
-      setCounterVector( module, n );
-    }
-    if ( numCategories == getChangeVector( module ).length() ){
-      IntegerVector c = appendVector( getChangeVector( module ), getCapacity( module ) );
-      setChangeVector( module, c );
-    }
-    setWeight( module, newCategoryIndex, model.newWeight( module, x ) );
-    counterUpdate( module, newCategoryIndex );
-    incChange( module, newCategoryIndex );
-    setNumCategories( module, newCategoryIndex + 1 );
-    setJmax( module, newCategoryIndex );
+  if ( batch ){
+    core::ART::trainBatch( state, data, batchSize, threads );
   }
-  
-  void learn( IModel &model,
-              int id,
-              NumericVector d ){
-    List module = getModule( model.net, id );
-    
-    int nc = getNumCategories( module );
-    if ( nc == 0 ){
-      newCategory( model, module, d );
-    }
-    else{
-      NumericVector a = activation( model, module, d );
-      NumericVector T_j = sortIndex( a );
-      bool resonance = false;
-      int j = 0;
-      while( !resonance ){
-        int J_max = T_j( j );
-        double m = match( model, module, J_max, d );
-        if ( m >= getRho( module ) ){
-          setJmax( module, J_max );
-          weightUpdate( model, module, J_max, d );
-          counterUpdate( module, J_max );
-          resonance = true;
-          if ( hasMoreModules( model.net, id ) ){
-            // match >= rho_a, then move up to the next module in the hierarchy
-            // the weight of this node will be the input for the next module
-            
-            learn( model, id+1, model.getNextLayerInput( getWeight( module, J_max ) ) );
-          }
-        }
-        else{
-          if ( j == getNumCategories( module ) - 1 ){
-            newCategory( model, module, d );
-            resonance = true;
-            if ( hasMoreModules( model.net, id ) ){
-              // match >= rho_a, then move up to the next module in the hierarchy
-              // the weight of this node will be the input for the next module
-              // NumericVector w =  as<NumericMatrix>( module["w"] )( J_max, _ );
-              learn( model, id+1, model.getNextLayerInput( getWeight( module, j+1 ) ) );
-            }
-          }
-          else{
-            j++;
-          } // if
-        } // match
-      } // while resonance
-    } // if
-    
+  else if ( speculative ){
+    core::ART::trainSpeculative( state, data, 0, threads );
   }
-  
-  int classify ( IModel &model,
-                 int id,
-                 NumericVector d ){
-    List module = ART::getModule( model.net, id );
-    int category = -1;
-    
-    NumericVector a = activation( model, module, d );
-    NumericVector T_j = sortIndex( a );
-    bool resonance = false;
-    int j = 0;
-    
-    while(!resonance){
-      int J_max = T_j( j );
-      double m = match( model, module, J_max, d );
-      if ( m >= getRho( module ) ){
-        setJmax( module, J_max );
-        category = J_max;
-        resonance = true;
-      }
-      else{
-        if ( j  == getNumCategories( module ) - 1 ){
-          setJmax( module, category );
-          resonance = true;
-        }
-        else{
-          j++;
-        } // if
-      } // match
-    } // while resonance
-    
-    return category;
+  else if ( deferred ){
+    core::ART::trainDeferred( state, data, threads );
   }
-  
-  void train( IModel &model,
-              NumericMatrix x){
-    
-    int ep = getMaxEpochs( model.net );
-    int nrow = x.rows();
-    int numModules = getNumModules( model.net );
-    for (int i = 1; i <= ep; i++){
-      
-      std::cout << "Epoch no. " << i << std::endl;
-      
-      int id = getModule( model.net, 0 )["id"];
-      for ( int k = 0; k < nrow; k++ ){
-        learn( model, id, model.processCode( x( k, _ ) ) );
-      }
-      
-      for ( int j = 0; j < numModules; j++ ){
-        int change = getModuleChange( ART::getModule( model.net, j ) );
-        std::cout << "ID " << j << " Number of changes: " << change << std::endl;
-      }
-      if ( getTotalChange( model.net ) == 0 ) {
-        ART::setEpoch( model.net, i );
-        break;
-      } else{
-        if ( i < ep ){
-          // only reset counters if it hasn't reached the maximum epoch
-          // that way if the user wants to stop the learning using fewer epochs
-          // then the node counters are still available for inspection
-          int n  = getNumModules( model.net );
-          for ( int j = 0; j < n; j++ ){
-            List module = getModule( model.net, j );
-            counterReset( module );
-            changeReset( module );
-          }
-        }
-      }
-    }
-    // subset weight matrix; loop through all modules
-    int l = getNumModules( model.net );
-    for ( int i = 0; i < l; i++ ){
-      List module = getModule( model.net, i );
-      int numCategories = getNumCategories( module );
-      setWeightMatrix( module, subsetRows( getWeightMatrix( module ), numCategories ) );
-      setCounterVector( module, subsetVector( getCounterVector( module ), numCategories ) );
-      setChangeVector( module, subsetVector( getChangeVector( module ), numCategories ) );
-    }
+  else{
+    core::ART::train( state, data, activeSet );
   }
   
-  List predict( IModel &model,
-                int id,
-                NumericMatrix x ){
-    List classified;
-    int nrow = x.rows();
-    NumericVector category( nrow );
-    
-    for (int i = 0; i < nrow; i++){
-      // currently supports only one module
-      int result = classify( model, id, model.processCode( x( i,_ ) ) );
-      if ( result == -1 ){
-        category( i ) = NA_INTEGER;
-      }
-      else{
-        category( i ) = result;
-      }
-      
-    }
-    classified = List::create( _["category"] = category );
-    
-    return classified;
-    
-  }
+  native::updateNetwork( state, net );
+  return native::trainResult( state, stats ? &counters : NULL );
+}
 
+// [[Rcpp::export(.trainARTFile)]]
+List trainFile ( List net, std::string file, int chunkSize, bool stats = false,
+                 RObject progress = R_NilValue, double progressInterval = 1,
+                 Nullable< List > convergence = R_NilValue, bool activeSet = false ){
+  core::Network state = native::toNetwork( net );
+  core::Stats counters;
+  if ( stats ){
+    state.stats = &counters;
+  }
+  std::unique_ptr< core::ProgressSink > sink = native::progressSink( progress, progressInterval );
+  state.progress = sink.get();
+  state.convergence = native::toConvergence( convergence );
+  core::FileStream data( file, chunkSize );
+  
+  core::initR_bar( state, data );
+  if ( !state.initialized ) {
+    core::ART::init( state );
+  }
+  core::ART::train( state, data, activeSet );
+  
+  native::updateNetwork( state, net );
+  return List::create( _["names"] = data.names(),
+                       _["stats"] = stats ? RObject( native::toList( counters ) ) : RObject(),
+                       _["stopReason"] = core::stopReasonName( state.stopReason ) );
 }
 
-// [[Rcpp::export(.trainART)]]
-void train ( List net, NumericMatrix x ){
-  IModel *model;
-  
-  if ( isFuzzy( net ) ){
-    model = new Fuzzy( net );
-  }
-  
-  if ( isHypersphere( net ) ){
-    model = new Hypersphere( net, x );
-  }
+// [[Rcpp::export(.trainShardedART)]]
+List trainSharded ( List net, NumericMatrix x, int shards, int threads = 0, bool compare = false,
+                    Nullable< List > convergence = R_NilValue ){
+  core::Network state = native::toNetwork( net );
+  state.convergence = native::toConvergence( convergence );
+  std::vector< double > rows = native::rowMajor( x );
+  core::Rows data( rows.data(), x.nrow(), x.ncol() );
+  
+  core::initR_bar( state, data );
+  if ( !state.initialized ) {
+    core::ART::init( state );
+  }
+  core::ShardReport r = core::ART::trainSharded( state, data, shards, threads, compare );
+  
+  native::updateNetwork( state, net );
+  List report = List::create( _["shards"] = r.shards,
+                              _["shardCategories"] = r.shardCategories,
+                              _["categories"] = r.categories,
+                              _["shardTime"] = r.shardTime,
+                              _["mergeTime"] = r.mergeTime );
+  if ( r.compared ){
+    report.push_back( r.serialCategories, "serialCategories" );
+    report.push_back( r.serialTime, "serialTime" );
+    report.push_back( r.agreement, "agreement" );
+  }
+  return List::create( _["sharding"] = report,
+                       _["stopReason"] = core::stopReasonName( state.stopReason ) );
+}
 
-  if ( isART1( net ) ){
-    model = new ART1( net );
+// [[Rcpp::export(.partialTrainART)]]
+List partialTrain ( List net, NumericMatrix x ){
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  core::Network &state = native::cachedNetwork( net );
+  std::vector< double > rows = native::rowMajor( x );
+  core::Rows data( rows.data(), x.nrow(), x.ncol() );
+  
+  core::PartialTrainResult result;
+  try {
+    // R_bar is estimated from the first part of the stream only
+    core::initR_bar( state, data );
+    if ( !state.initialized ) {
+      core::ART::init( state );
+    }
+    result = core::ART::partialTrain( state, data );
   }
-  
-  if ( !ART::isInitialized( net ) ) {
-    ART::init( *model );
+  catch ( ... ){
+    native::dropNetwork( net );
+    throw;
   }
-  ART::train( *model, x );
-  
-  delete model;
   
+  native::syncNetwork( net );
+  std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+  return List::create( _["category"] = result.category,
+                       _["newCategory"] = result.newCategory,
+                       _["time"] = result.time,
+                       _["callTime"] = std::chrono::duration< double, std::micro >( end - start ).count() );
 }
 
 // [[Rcpp::export(.predictART)]]
-List predict ( List net, int id, NumericMatrix x ){
-  IModel *model;
+List predict ( List net, int id, NumericMatrix x, bool stats = false ){
+  core::Network state = native::toNetwork( net );
+  core::Stats counters;
+  if ( stats ){
+    state.stats = &counters;
+  }
+  std::vector< double > rows = native::rowMajor( x );
+  std::vector< int > category = core::ART::predict( state, id, core::Rows( rows.data(), x.nrow(), x.ncol() ) );
   
-  if ( isFuzzy( net ) ){
-    model = new Fuzzy( net );
+  List result = List::create( _["category"] = native::toRVector( category ) );
+  if ( stats ){
+    result.push_back( native::toList( counters ), "stats" );
   }
+  return result;
+}
 
-  if ( isHypersphere( net ) ){
-    model = new Hypersphere( net );
+// [[Rcpp::export(.predictHierarchyART)]]
+List predictHierarchy ( List net, NumericMatrix x, int width = 16, bool stats = false ){
+  if ( width < 1 ){
+    stop( "The width must be at least 1." );
+  }
+  core::Network state = native::toNetwork( net );
+  core::Stats counters;
+  if ( stats ){
+    state.stats = &counters;
+  }
+  std::vector< double > rows = native::rowMajor( x );
+  core::ART::HierarchyPrediction p = core::ART::predictHierarchy( state, core::Rows( rows.data(), x.nrow(), x.ncol() ), width );
+  
+  // the path of each row, a column for each module
+  IntegerMatrix path( x.nrow(), p.modules );
+  CharacterVector names( p.modules );
+  for ( int m = 0; m < p.modules; m++ ){
+    for ( int i = 0; i < x.nrow(); i++ ){
+      int c = p.path[(size_t)i * p.modules + m];
+      path( i, m ) = c == -1 ? NA_INTEGER : c;
+    }
+    names[m] = "module" + std::to_string( m );
   }
-
-  if ( isART1( net ) ){
-    model = new ART1( net );
+  colnames( path ) = names;
+  IntegerVector category = path( _, 0 );
+  List result = List::create( _["category"] = category,
+                              _["path"] = path,
+                              _["fallback"] = LogicalVector( p.fallback.begin(), p.fallback.end() ) );
+  if ( stats ){
+    result.push_back( native::toList( counters ), "stats" );
   }
-  List results = ART::predict( *model, id, x );
-  delete model;
-  return results;
+  return result;
 }
 
 // [[Rcpp::export(.ART)]]
@@ -569,4 +312,3 @@ List newART ( int dimension, int num = 1, double vigilance = 0.75, double learni
 bool isART ( List net ){
   return as<std::string>( net.attr( "class" ) ).compare( "ART" ) == 0;
 }
-
@@ -7,7 +7,6 @@
 
 
 #include <Rcpp.h>
-#include "IModel.h"
 using namespace Rcpp;
 
 #ifndef ART_H
@@ -20,60 +19,27 @@ bool isART ( List net );
 namespace ART {
         List create ( int dimension, int num = 1, double vigilance = 0.75, double learningRate = 1.0, int categorySize = 100, int maxEpochs = 20 );
         int getID( List module );
-        int getJmax( List module, int matchIndex = 0 );
-        void setJmax( List module, int J, int matchIndex = 0 );
         void addJmax( List module, int J );
-        int getMaxEpochs( List net );
-        void setEpoch( List net, int epoch );
-        void incChange( List module, int index );
-        int getModuleChange( List module );
-        int getTotalChange( List net );
-        IntegerVector getChangeVector( List module );
-        void setChangeVector( List module, IntegerVector v );
-        void changeReset( List module );
         int getNumModules( List net );
         List module ( int id, double vigilance = 0.75, double learningRate = 1.0, int categorySize = 100 );
         List getModule( List net, int moduleID );
         void setModule( List net, List module );
-        bool hasMoreModules( List net, int currentModuleID );
-        NumericMatrix getWeightMatrix( List module );
-        void setWeightMatrix( List module, NumericMatrix w );
         int getWeightDimension( List module );
-        void setWeightDimension( List module, int dimension );
-        void initWeights( List module, int dim );
-        NumericVector getWeight( List module, int weightIndex );
-        void setWeight( List module, int weightIndex, NumericVector w );
-        double getRho( List module );
-        void setRho( List module, double rho );
-        int getNumCategories( List module );
-        void setNumCategories( List module, int x );
         double getLearningRate( List module );
-        void setLearningRate( List module, double learningRate );
-        int getDimension( List module );
-        int getCapacity( List module );
-        int getCounter( List module, int weightIndex );
-        IntegerVector getCounterVector( List module );
         double getAlpha( List module );
-        double getEpsilon( List module );
-        void setCounterVector( List module, IntegerVector v );
-        void counterReset( List module );
-        void initModule( List module, int weightDimension );
-        void init( IModel &model );
+        int getDimension( List module );
         bool isInitialized( List net );
-        
-        NumericVector activation( IModel &model, List module, NumericVector x );
-        double match( IModel &model, List module, int weightIndex , NumericVector x);
-        void weightUpdate( IModel &model, List module, int weightIndex, NumericVector x );
-        void counterUpdate( List module, int nodeIndex );
-        void newCategory( IModel &model, List module, NumericVector x );
-        void learn( IModel &model, int id, NumericVector d );
-        int classify( IModel &model, int id, NumericVector d );
-        
-        void train( IModel &model, NumericMatrix x );
-        List predict( IModel &model, int id, NumericMatrix x );
 }
 
-void train ( List net, NumericMatrix x );
-List predict ( List net, int id, NumericMatrix x );
+List train ( List net, NumericMatrix x, bool stats = false, RObject progress = R_NilValue, double progressInterval = 1,
+             Nullable< List > convergence = R_NilValue, bool activeSet = false, bool batch = false,
+             int batchSize = 10000, bool speculative = false, int threads = 0 );
+List trainFile ( List net, std::string file, int chunkSize, bool stats = false,
+                 RObject progress = R_NilValue, double progressInterval = 1,
+                 Nullable< List > convergence = R_NilValue, bool activeSet = false );
+List trainSharded ( List net, NumericMatrix x, int shards, int threads = 0, bool compare = false,
+                    Nullable< List > convergence = R_NilValue );
+List partialTrain ( List net, NumericMatrix x );
+List predict ( List net, int id, NumericMatrix x, bool stats = false );
 
 #endif
@@ -7,11 +7,13 @@
 
 
 #include <Rcpp.h>
+#include <chrono>
+#include <cmath>
+#include <algorithm>
 #include "ART.h"
-#include "utils.h"
-#include "fuzzy.h"
-#include "art1.h"
-#include "hypersphere.h"
+#include "core.h"
+#include "native.h"
+#include "core-stream.h"
 using namespace Rcpp;
 
 
@@ -29,8 +31,8 @@ namespace ARTMAP {
     List module = List::create( _["id"] = id,                   // module id
                                 _["weightDimension"] = 0      , // the number of dimensions in the weight
                                 _["capacity"] = categorySize,   // number of category to create when the module runs out of categories to match
-                                _["alpha"] = 0.001,             // activation function parameter
-                                _["epsilon"] = 0.000001,        // match function parameter
+                                _["alpha"] = core::ALPHA,       // activation function parameter
+                                _["epsilon"] = core::EPSILON,   // match function parameter
                                 _["rho"] = vigilance,           // vigilance parameter
                                 _["beta"] = learningRate,       // learning parameter
                                 _["change"] = change            // keep track of the number of changes in the mapfield
@@ -54,608 +56,8 @@ namespace ARTMAP {
   bool isSimplified( List net ){
     return as<bool>( net.attr( "simplified" ) );
   }
-
-  List getMapfield ( List net ){
-    return net["mapfield"];
-  }
-  
-  List getModule_a( List net ){
-    return as<List>( net["module"] )["a"];
-  }
-  
-  List getModule_b( List net ){
-    return as<List>( net["module"] )["b"];
-  }
-
-  namespace simplified {
-  
-    int getWeight( List mapfield, int index ){
-      return as<IntegerVector>( mapfield["w"] )[index];
-    }
-    
-    void setWeight( List mapfield, int index, int w ){
-      IntegerVector v = mapfield["w"];
-      v( index ) = w;
-    }
-    
-    IntegerVector getWeightVector( List mapfield ){
-      return mapfield["w"];
-    }
-    
-    void setWeightVector( List mapfield, IntegerVector v ){
-      mapfield["w"] = v;
-    }
-    
-    void newCategory( List mapfield, int label ){
-      int numCategories = ART::getNumCategories( mapfield );
-      int newCategoryIndex = numCategories;
-      IntegerVector wm = getWeightVector( mapfield );
-      if ( numCategories == wm.length() ){
-        // reached the max capacity, so add more rows
-        IntegerVector newWeight = appendVector( wm, ART::getCapacity( mapfield ) );
-        setWeightVector( mapfield, newWeight );
-        
-        IntegerVector c = appendVector( ART::getChangeVector( mapfield ), ART::getCapacity( mapfield ) );
-        ART::setChangeVector( mapfield, c );
-      }
-      setWeight( mapfield, newCategoryIndex, label );
-      ART::incChange( mapfield, newCategoryIndex );
-      ART::setNumCategories( mapfield, numCategories + 1 );
-      
-    }
-    void initMapfield( List mapfield ){
-      int size = ART::getCapacity( mapfield );
-      
-      IntegerVector w( size );
-      setWeightVector( mapfield, w );
-      
-      IntegerVector c(size);
-      ART::setChangeVector( mapfield, c );
-    }
-    
-    void learn ( IModel &model, NumericVector d, int label){
-      List module = ART::getModule( model.net, 0 );
-      List mapfield = getMapfield( model.net );
-      
-      int nc = ART::getNumCategories( module );
-      if ( nc == 0 ){
-        
-        ART::newCategory( model, module, d );
-        newCategory( mapfield, label );
-        
-      }
-      else{
-        NumericVector a = ART::activation( model, module, d );
-        NumericVector T_j = sortIndex( a );
-        bool resonance = false;
-        int j = 0;
-        double rho = ART::getRho( module );
-        while( !resonance ){
-          int J_max = T_j( j );
-          
-          double m = ART::match( model, module, J_max, d );
-          
-          if ( m >= rho ){
-            if ( getWeight( mapfield, J_max ) == label ){
-              ART::setJmax( module, J_max );
-              ART::weightUpdate( model, module, J_max, d );
-              ART::counterUpdate( module, J_max );
-              resonance = true;
-            }
-            else{
-              rho = std::min( m + ART::getEpsilon( module ), 1.0 );
-              
-              if ( j == ART::getNumCategories( module ) - 1 ){
-                ART::setJmax( module, j + 1 );
-                ART::newCategory( model, module, d );
-                newCategory( mapfield, label );
-                resonance = true;
-              }
-              else{
-                j++;
-              } // if
-            } // mapfield == label
-          } // match >= rho_a
-          else{
-            if ( j == ART::getNumCategories( module ) - 1 ){
-              ART::setJmax( module, j + 1 );
-              ART::newCategory( model, module, d );
-              newCategory( mapfield, label );
-              resonance = true;
-            }
-            else{
-              j++;
-            } // if
-          } // match fails
-        } // while resonance
-      } // if
-      
-    }
-    
-    int test( int predicted, int label ){
-      int matched = NA_INTEGER;
-      matched = predicted == label? 1 : 0;
-      
-      return matched;
-    }
-    
-    // simplified classification
-    List classify( IModel &model, NumericVector d ){
-      
-      List module = getModule_a( model.net );
-      List mapfield = getMapfield( model.net );
-      int category = NA_INTEGER;
-      int predicted = NA_INTEGER;
-      
-      int nc = ART::getNumCategories( module );
-      
-      NumericVector a = ART::activation( model, module, d );
-      NumericVector T_j = sortIndex( a );
-      bool resonance = false;
-      int j = 0;
-      double rho = ART::getRho( module );
-      while( !resonance ){
-        int J_max = T_j( j );
-        
-        double m = ART::match( model, module, J_max, d );
-        
-        if ( m >= rho ){
-          
-          category = J_max;
-          predicted = getWeight( mapfield, J_max );
-          resonance = true;
-          
-        } // match >= rho_a
-        else{
-          if ( j == nc - 1 ){
-            // can't find a match
-            ART::setJmax( module, NA_INTEGER );
-            resonance = true;
-          }
-          else{
-            // search for the next best matching node in F2a
-            j++;
-          } // if
-        } // match fails
-      } // while resonance
-      
-      return ( List::create( _["category_a"] = category,
-                             _["predicted"] = predicted ) );
-    }
-  
-    void subsetMapfield( List mapfield ){
-      int numCategories = ART::getNumCategories( mapfield );
-      setWeightVector( mapfield, subsetVector( getWeightVector( mapfield ), numCategories ) );
-      ART::setChangeVector( mapfield, subsetVector( ART::getChangeVector( mapfield ), numCategories ) );
-    }
-  }
-
-  namespace standard {
-  // recall reactivates the F2b node based on the mapfield weights to retrieve its F1b pattern
-    NumericVector recall( List module_b, NumericVector mapfield ){
-      // find which mapfield node is active (either 1 or 0)
-      int l = mapfield.length();
-      int nodeIndex_b = -1;
-      for ( int i = 0; i < l; i++ ){
-        if ( mapfield[i] == 1 ){
-          nodeIndex_b = i;
-          break;
-        }
-      }
-      
-      NumericVector F1;
-      if ( nodeIndex_b == -1 ){
-        F1( ART::getWeightMatrix( module_b ).cols() );
-        // Can't find the node b in F2. Something is wrong. Return all NA
-        F1.fill( NA_INTEGER );
-        return F1;
-      }
-      F1 = ART::getWeight( module_b, nodeIndex_b ); 
-      
-      return F1;
-    }
-    
-    double match( IModel &model, List mapfield, int nodeIndex_a, int nodeIndex_b ){
-      NumericVector w_a = ART::getWeight( mapfield, nodeIndex_a );
-      NumericVector yb( w_a.length(), 0 );
-      yb( nodeIndex_b ) = 1;
-      
-      double a = model.match( mapfield, yb, w_a );
-      return a;
-    }
-    
-    void mapfieldUpdate( IModel &model, List mapfield, int nodeIndex_a, int nodeIndex_b ){
-      NumericVector w_a = ART::getWeight( mapfield, nodeIndex_a );
-      NumericVector y_b( w_a.length(), 0 );
-      y_b( nodeIndex_b ) = 1;
-      ART::weightUpdate( model, mapfield, nodeIndex_a, y_b );
-      
-    }
-    
-    void setNumCategories_a( List mapfield, int x ){
-      mapfield["numCategories_a"] = x;
-    }
-    
-    void setNumCategories_b( List mapfield, int x ){
-      mapfield["numCategories_b"] = x;
-    }
-    
-    int getNumCategories_a( List mapfield ){
-      return mapfield["numCategories_a"];
-    }
-    
-    int getNumCategories_b( List mapfield ){
-      return mapfield["numCategories_b"];
-    }
-    
-    List getModule_a( List net ){
-      return as<List>( net["module"] )["a"];
-    }
-    
-    List getModule_b( List net ){
-      return as<List>( net["module"] )["b"];
-    }
-    
-    List getMapfield( List net ){
-      return net["mapfield"];
-    }
-  
-    void newCategory_a( List mapfield ){
-      
-      int numCategories = getNumCategories_a( mapfield );
-      int newCategoryIndex = numCategories;
-      NumericMatrix wm = ART::getWeightMatrix( mapfield );
-      NumericMatrix newWeight;
-      if ( numCategories == wm.rows() ){
-        // reached the max capacity, so add more rows
-        newWeight = appendRows( wm, ART::getCapacity( mapfield ) );
-        ART::setWeightMatrix( mapfield, newWeight );
-        
-        IntegerVector c = appendVector( ART::getChangeVector( mapfield ), ART::getCapacity( mapfield ) );
-        ART::setChangeVector( mapfield, c );
-      }
-      else{
-        newWeight = wm;
-      }
-      
-      ART::setWeight( mapfield, newCategoryIndex, rep( 1.0, wm.cols() ) );
-      ART::incChange( mapfield, newCategoryIndex );
-      setNumCategories_a( mapfield, numCategories + 1 );
-      
-    }
-    
-    void newCategory_b( List mapfield ){
-      
-      int numCategories = getNumCategories_b( mapfield );
-      int newCategoryIndex = numCategories;
-      NumericMatrix wm = ART::getWeightMatrix( mapfield );
-      NumericMatrix newWeight;
-      if ( numCategories == wm.cols() ){
-        // reached the max capacity, so add more columns
-        newWeight = appendColumns( wm, ART::getCapacity( mapfield ) );
-      }
-      else{
-        newWeight = wm;
-      }
-      newWeight( wm.rows() - 1, newCategoryIndex ) = 0;
-      ART::setWeightMatrix( mapfield, newWeight );
-      ART::setWeightDimension( mapfield, numCategories + 1 );
-      setNumCategories_b( mapfield, numCategories + 1 );
-    }
-  
-    void initMapfield( List mapfield ){
-      int size = ART::getCapacity( mapfield );
-      
-      NumericMatrix w( 1, size );
-      ART::setWeightMatrix( mapfield, w );
-      
-      IntegerVector c( size );
-      ART::setChangeVector( mapfield, c );
-    }
-  
-    void learn ( IModel &model, NumericVector d, NumericVector label ){
-   
-      List module_a = getModule_a( model.net );
-      List module_b = getModule_b( model.net );
-      List mapfield = getMapfield( model.net );
-      
-      // init
-      int nc_a = ART::getNumCategories( module_a );
-      int nc_b = ART::getNumCategories( module_b );
-      int nc_ab_a = getNumCategories_a( mapfield );
-      int nc_ab_b = getNumCategories_b( mapfield );
-      if ( nc_a == 0  && nc_b == 0  && nc_ab_a == 0 && nc_ab_b == 0 ){
-        
-        ART::newCategory( model, module_a, d );
-        ART::newCategory( model, module_b, label );
-        // Add new category in b first before a
-        newCategory_b( mapfield );
-        newCategory_a( mapfield );
-        mapfieldUpdate( model, mapfield, 0, 0 );
-        
-      }
-      else{
-        ART::learn( model, ART::getID( module_b ), label );
-        // add a new ab category whenever a new category is added in F2b
-        if ( ART::getNumCategories( module_b ) > getNumCategories_b( mapfield ) ){
-          // update nodes in mapfield
-          newCategory_b( mapfield );
-        }
-        // get ART a F2 activations
-        NumericVector a = ART::activation( model, module_a, d );
-        NumericVector T_j = sortIndex( a );
-        bool resonance = false;
-        int j = 0;
-        double rho_a = ART::getRho( module_a );
-        while( !resonance ){
-          int Jmax_a = T_j( j );
-          
-          double m = ART::match( model, module_a, Jmax_a, d );
-          
-          if ( m >= rho_a ){
-            // check the mapfield
-            
-            double m_ab = match( model, mapfield, Jmax_a, ART::getJmax( module_b ) );
-            
-            if ( m_ab >= ART::getRho( mapfield ) ){
-              ART::setJmax( module_a, Jmax_a );
-              ART::weightUpdate( model, module_a, Jmax_a, d );
-              ART::counterUpdate( module_a, Jmax_a );
-              mapfieldUpdate( model, mapfield, Jmax_a, ART::getJmax( module_b ) );
-              
-              resonance = true;
-            }
-            
-            if ( !resonance ){
-              
-              rho_a = std::min( m + ART::getEpsilon( module_a ), 1.0 );
-              
-              // if run out of categories, then add a new one
-              if ( j == ART::getNumCategories( module_a ) - 1 ){
-                j++;
-                ART::setJmax( module_a, j );
-                
-                // add a new F2 node in ART a
-                ART::newCategory( model, module_a, d );
-                
-                // add a new node in ART ab
-                newCategory_a( mapfield );
-                mapfieldUpdate( model, mapfield, j, ART::getJmax( module_b ) );
-                
-                resonance = true;
-              }
-              else{
-                j++;
-              } // if
-            } // resonance
-          }
-          else{
-            if ( j == ART::getNumCategories( module_a ) - 1 ){
-              j++;
-              ART::setJmax( module_a, j );
-              ART::newCategory( model, module_a, d );
-              
-              // add a new node in ART ab
-              newCategory_a( mapfield );
-              
-              mapfieldUpdate( model, mapfield, j, ART::getJmax( module_b ) );
-              
-              resonance = true;
-              
-            }
-            else{
-              j++;
-            } // if
-          } // match fails
-        } // while resonance
-      } // if
-      
-    }
-    
-    int test( IModel &model, NumericVector label ) {
-      
-      int matched = NA_INTEGER;
-      
-      List mapfield = getMapfield( model.net );
-      List module_a = getModule_a( model.net );
-      List module_b = getModule_b( model.net );
-      
-      int category_b = ART::classify( model, ART::getID( module_b ), label );
-      
-      int Jmax_a = ART::getJmax( module_a );
-      
-      if ( category_b != NA_INTEGER && Jmax_a != NA_INTEGER ){
-        double m_ab = match( model, mapfield, Jmax_a, category_b );
-        matched = m_ab >= ART::getRho( mapfield ) ? 1 : 0;
-      }
-      
-      return matched;
-    }
-    
-    List classify( IModel &model, NumericVector d ){
-      
-      List mapfield = getMapfield( model.net );
-      List module_a = getModule_a( model.net );
-      List module_b = getModule_b( model.net );
-      
-      // best matching node in F2a
-      int category_a = NA_INTEGER;
-      
-      NumericVector predicted( getNumCategories_b( mapfield ), NA_REAL );
-      NumericVector F1_b( ART::getWeightMatrix( module_b ).cols(), NA_REAL );
-      
-      NumericVector a = ART::activation( model, module_a, d );
-      NumericVector T_j = sortIndex( a );
-      bool resonance = false;
-      int j = 0;
-      double rho_a = ART::getRho( module_a );
-      while( !resonance ){
-        int Jmax_a = T_j( j );
-        double m = ART::match( model, module_a, Jmax_a, d );
-        
-        if ( m >= rho_a ){
-          // prediction
-          category_a = Jmax_a;
-          ART::setJmax( module_a, Jmax_a );
-          predicted = ART::getWeight( mapfield, Jmax_a );
-          F1_b = recall( module_b, predicted );
-          
-          resonance = true;
-        }
-        else {
-          // if it runs out of categories, then it can't find a match
-          if ( j == ART::getNumCategories( module_a ) - 1 ){
-            ART::setJmax( module_a, NA_INTEGER );
-            resonance = true;
-          }
-          else{
-            // search for the next best matching node in F2a
-            j++;
-          } // if
-        } // else
-        
-      } // while resonance
-      
-      return List::create( _["category_a"] = category_a,
-                           _["F1_b"] = F1_b );
-      
-    }
-  
-    void subsetMapfield( List mapfield ){
-      int numCategories_a = getNumCategories_a( mapfield );
-      int numCategories_b = getNumCategories_b( mapfield );
-      ART::setWeightMatrix( mapfield, subsetRows( subsetColumns( 
-                                                                ART::getWeightMatrix( mapfield ), numCategories_b 
-                                                               ),
-                                                  numCategories_a )
-                          );
-      ART::setChangeVector( mapfield, subsetVector( ART::getChangeVector( mapfield ), numCategories_a ) );
-    }
-  
-  }
-
-  void init( IModel &model ){
-    List mapfield = getMapfield( model.net );
-    if ( isSimplified( model.net ) ){
-      simplified::initMapfield( mapfield );
-    } else{
-      standard::initMapfield( mapfield );
-    }
-  }
-
-  void train( IModel &model,
-              NumericMatrix x,
-              Nullable<NumericVector> vTarget,
-              Nullable< NumericMatrix > mTarget ){
-    
-    int ep = ART::getMaxEpochs( model.net );
-    int nrow = x.rows();
-    if ( !isARTMAP( model.net ) ){
-      stop( "The network is not an ARTMAP." );
-    }
-    if ( !mTarget.isNotNull() && !isSimplified( model.net ) ){
-      stop( "The labels are missing. End running." );
-    }
-    else if ( !vTarget.isNotNull() && isSimplified( model.net ) ){
-      stop("The labels are missing. End running.");
-    }
-    for (int i = 1; i <= ep; i++){
-      std::cout << "Epoch no. " << i << std::endl;
-      
-      for (int j = 0; j < nrow; j++){
-        if ( isSimplified( model.net ) )
-          simplified::learn( model, model.processCode( x( j, _ ) ), NumericVector ( vTarget )( j ) );
-        else 
-          standard::learn( model, model.processCode( x( j, _ ) ), model.processCode( NumericMatrix ( mTarget )( j, _ ) ) );
-      }
-      
-      List mapfield = getMapfield( model.net );
-      int change = ART::getTotalChange( model.net ) + ART::getModuleChange( mapfield );
-      std::cout << "Number of changes " << change << std::endl;
-      if ( change == 0 ) {
-        ART::setEpoch( model.net, i );
-        break;
-      } else{
-        List module_a = getModule_a( model.net );
-        ART::changeReset( module_a );
-        ART::counterReset( module_a );
-        
-        ART::changeReset( mapfield );
-        
-        if ( !isSimplified( model.net ) ){
-          List module_b = getModule_b( model.net );
-          ART::changeReset( module_b );
-          ART::counterReset( module_b );
-        }
-      }
-    }
-    // subset module weight matrix, counter and change vectors
-    int l = ART::getNumModules( model.net );
-    for ( int i = 0; i < l; i++ ){
-      List module = ART::getModule( model.net, i );
-      int numCategories = ART::getNumCategories( module );
-      ART::setWeightMatrix( module, subsetRows( ART::getWeightMatrix( module ), numCategories ) );
-      ART::setCounterVector( module, subsetVector( ART::getCounterVector( module ), numCategories ) );
-      ART::setChangeVector( module, subsetVector( ART::getChangeVector( module ), numCategories ) );
-    }
-    
-    // subset mapfield weight matrix, counter and change vectors
-    if ( isSimplified( model.net ) ){
-      simplified::subsetMapfield( getMapfield( model.net ) );
-    }
-    else{
-      standard::subsetMapfield( getMapfield( model.net ) );
-    }
-  }
-  
-  List predict( IModel &model,
-                NumericMatrix x,
-                Nullable< NumericVector > vTarget = R_NilValue ,
-                Nullable< NumericMatrix > mTarget = R_NilValue){
-    List classified;
-    int nrow = x.rows();
-    int ncol = x.cols();
-    IntegerVector category_a( nrow ), matched( nrow );
-    
-    if ( isSimplified( model.net ) ){
-      NumericVector predicted ( nrow );
-      for ( int i = 0; i < nrow; i++ ){
-        
-        List result = simplified::classify( model, model.processCode( x( i,_ ) ) );
-        category_a( i ) = result( "category_a" );
-        predicted( i ) = result( "predicted" );
-        if ( vTarget.isNotNull() ){
-          matched( i ) = simplified::test( predicted( i ), NumericVector( vTarget )( i ) );
-        }
-        
-      }
-      classified = List::create( _["predicted"] = predicted,
-                                 _["category_a"] = category_a,
-                                 _["matched"] = matched);
-    }
-    else{
-      NumericMatrix predicted( nrow, ncol );
-      
-      for ( int i = 0; i < nrow; i++ ){
-        List result = standard::classify( model, model.processCode( x( i,_ ) ) );
-        predicted( i, _ ) = model.unProcessCode( result( "F1_b" ) );
-        category_a( i ) = result( "category_a" );
-        if ( mTarget.isNotNull() ){
-          matched( i ) = standard::test( model, model.processCode( NumericMatrix ( mTarget )( i, _ ) ) );
-        }
-      }
-      
-      classified = List::create( _["predicted"] = predicted,
-                                 _["category_a"] = category_a,
-                                 _["matched"] = matched );
-    }
-    
-    return classified;
-    
-  } 
 }
 
-
 // [[Rcpp::export(.ARTMAP)]]
 List newARTMAP ( int dimension, int num = 1, double vigilance = 0.75, double learningRate = 1.0, int categorySize = 100, int maxEpochs = 20, bool simplified = false ){
   if ( vigilance < 0.0 || vigilance > 1.0 ){
@@ -689,57 +91,170 @@ List newARTMAP ( int dimension, int num = 1, double vigilance = 0.75, double lea
   return net;
 }
 
+namespace {
+
+  // target: the labels (simplified) or the target matrix (standard) as a row-major matrix,
+  // with no rows if there is none
+  std::vector< double > target( List net, Nullable< NumericVector > vTarget, Nullable< NumericMatrix > mTarget,
+                                int &nrow, int &ncol ){
+    nrow = 0;
+    ncol = 0;
+    if ( ARTMAP::isSimplified( net ) ){
+      if ( !vTarget.isNotNull() ){
+        return std::vector< double >();
+      }
+      NumericVector v( vTarget );
+      nrow = v.length();
+      ncol = 1;
+      return std::vector< double >( v.begin(), v.end() );
+    }
+    if ( !mTarget.isNotNull() ){
+      return std::vector< double >();
+    }
+    NumericMatrix m( mTarget );
+    nrow = m.nrow();
+    ncol = m.ncol();
+    return native::rowMajor( m );
+  }
+}
+
 // [[Rcpp::export(.trainARTMAP)]]
-void trainARTMAP ( List net, NumericMatrix x, Nullable< NumericVector > vTarget = R_NilValue, Nullable< NumericMatrix > mTarget = R_NilValue ){
-  IModel *model;
-  
-  if ( isFuzzy( net ) ){
-    model = new Fuzzy( net );
+List trainARTMAP ( List net, NumericMatrix x, Nullable< NumericVector > vTarget = R_NilValue, Nullable< NumericMatrix > mTarget = R_NilValue,
+                   bool stats = false, RObject progress = R_NilValue, double progressInterval = 1,
+                   Nullable< List > convergence = R_NilValue ){
+  if ( !isARTMAP( net ) ){
+    stop( "The network is not an ARTMAP." );
+  }
+  int nrow, ncol;
+  std::vector< double > labels = target( net, vTarget, mTarget, nrow, ncol );
+  if ( ncol == 0 ){
+    stop( "The labels are missing. End running." );
   }
   
-  if ( isHypersphere( net ) ){
-    if ( ARTMAP::isSimplified( net ) ){
-      model = new Hypersphere( net, x );
-    }
-    else{
-      stop( "The hypersphere model can only be used in the simplified ARTMAP." );
-    }
+  core::Network state = native::toNetwork( net );
+  core::Stats counters;
+  if ( stats ){
+    state.stats = &counters;
   }
+  std::unique_ptr< core::ProgressSink > sink = native::progressSink( progress, progressInterval );
+  state.progress = sink.get();
+  state.convergence = native::toConvergence( convergence );
+  std::vector< double > rows = native::rowMajor( x );
+  core::Rows data( rows.data(), x.nrow(), x.ncol() );
   
-  if ( isART1( net ) ){
-    model = new ART1( net );
+  core::initR_bar( state, data );
+  if ( !state.initialized ){
+    core::ARTMAP::init( state );
   }
+  core::ARTMAP::train( state, data, core::Rows( labels.data(), nrow, ncol ) );
   
-  if ( !ART::isInitialized( net ) ){
-    ART::init( *model );
+  native::updateNetwork( state, net );
+  return native::trainResult( state, stats ? &counters : NULL );
+}
+
+// [[Rcpp::export(.trainARTMAPFile)]]
+List trainARTMAPFile ( List net, std::string file, int targetColumns, int chunkSize, bool stats = false,
+                       RObject progress = R_NilValue, double progressInterval = 1,
+                       Nullable< List > convergence = R_NilValue ){
+  if ( !isARTMAP( net ) ){
+    stop( "The network is not an ARTMAP." );
+  }
+  core::Network state = native::toNetwork( net );
+  core::Stats counters;
+  if ( stats ){
+    state.stats = &counters;
   }
-  ARTMAP::train( *model, x, vTarget, mTarget );
+  std::unique_ptr< core::ProgressSink > sink = native::progressSink( progress, progressInterval );
+  state.progress = sink.get();
+  state.convergence = native::toConvergence( convergence );
+  core::FileStream data( file, chunkSize, targetColumns );
   
-  delete model;
+  core::initR_bar( state, data );
+  if ( !state.initialized ){
+    core::ARTMAP::init( state );
+  }
+  core::ARTMAP::train( state, data );
   
+  native::updateNetwork( state, net );
+  std::vector< std::string > names = data.names();
+  names.resize( std::min( names.size(), (size_t)data.cols() ) );
+  return List::create( _["names"] = names,
+                       _["stats"] = stats ? RObject( native::toList( counters ) ) : RObject(),
+                       _["stopReason"] = core::stopReasonName( state.stopReason ) );
 }
 
-// [[Rcpp::export(.predictARTMAP)]]
-List predictARTMAP ( List net, NumericMatrix x, Nullable< NumericVector > vTarget = R_NilValue, Nullable< NumericMatrix > mTarget = R_NilValue ){
+// [[Rcpp::export(.partialTrainARTMAP)]]
+List partialTrainARTMAP ( List net, NumericMatrix x, Nullable< NumericVector > vTarget = R_NilValue, Nullable< NumericMatrix > mTarget = R_NilValue ){
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  if ( !isARTMAP( net ) ){
+    stop( "The network is not an ARTMAP." );
+  }
+  int nrow, ncol;
+  std::vector< double > labels = target( net, vTarget, mTarget, nrow, ncol );
+  if ( ncol == 0 ){
+    stop( "The labels are missing. End running." );
+  }
   
-  IModel *model;
-  if ( isFuzzy( net ) ){
-    model = new Fuzzy ( net );
+  core::Network &state = native::cachedNetwork( net );
+  std::vector< double > rows = native::rowMajor( x );
+  core::Rows data( rows.data(), x.nrow(), x.ncol() );
+  
+  core::PartialTrainResult result;
+  try {
+    // R_bar is estimated from the first part of the stream only
+    core::initR_bar( state, data );
+    if ( !state.initialized ){
+      core::ARTMAP::init( state );
+    }
+    result = core::ARTMAP::partialTrain( state, data, core::Rows( labels.data(), nrow, ncol ) );
   }
-  if ( isHypersphere( net ) ){
-    if ( ARTMAP::isSimplified( net ) ){
-      model = new Hypersphere( net, x );
-    }
-    else{
-      stop( "The hypersphere model can only be used in the simplified ARTMAP." );
-    }
+  catch ( ... ){
+    native::dropNetwork( net );
+    throw;
   }
   
-  if ( isART1( net ) ){
-    model = new ART1( net );
+  native::syncNetwork( net );
+  std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+  return List::create( _["category_a"] = result.category,
+                       _["newCategory"] = result.newCategory,
+                       _["time"] = result.time,
+                       _["callTime"] = std::chrono::duration< double, std::micro >( end - start ).count() );
+}
+
+// [[Rcpp::export(.predictARTMAP)]]
+List predictARTMAP ( List net, NumericMatrix x, Nullable< NumericVector > vTarget = R_NilValue, Nullable< NumericMatrix > mTarget = R_NilValue,
+                     bool stats = false ){
+  int nrow, ncol;
+  std::vector< double > labels = target( net, vTarget, mTarget, nrow, ncol );
+  
+  core::Network state = native::toNetwork( net );
+  core::Stats counters;
+  if ( stats ){
+    state.stats = &counters;
   }
+  std::vector< double > rows = native::rowMajor( x );
+  core::ARTMAP::Prediction p = core::ARTMAP::predict( state, core::Rows( rows.data(), x.nrow(), x.ncol() ),
+                                                      core::Rows( labels.data(), nrow, ncol ) );
   
-  List results = ARTMAP::predict( *model, x, vTarget, mTarget );
-  delete model;
-  return results;
-}
\ No newline at end of file
+  IntegerVector category_a = native::toRVector( p.category_a );
+  IntegerVector matched( p.matched.begin(), p.matched.end() );
+  List result;
+  if ( state.simplified ){
+    NumericVector predicted( p.predicted.size() );
+    for ( size_t i = 0; i < p.predicted.size(); i++ ){
+      predicted[i] = std::isnan( p.predicted[i] ) ? NA_REAL : p.predicted[i];
+    }
+    result = List::create( _["predicted"] = predicted,
+                           _["category_a"] = category_a,
+                           _["matched"] = matched );
+  }
+  else{
+    result = List::create( _["predicted"] = native::toMatrix( p.predicted, x.nrow(), p.predictedDimension ),
+                           _["category_a"] = category_a,
+                           _["matched"] = matched );
+  }
+  if ( stats ){
+    result.push_back( native::toList( counters ), "stats" );
+  }
+  return result;
+}
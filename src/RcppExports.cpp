@@ -11,26 +11,98 @@ Rcpp::Rostream<false>& Rcpp::Rcerr = Rcpp::Rcpp_cerr_get();
 #endif
 
 // train
-void train(List net, NumericMatrix x);
-RcppExport SEXP _rART_train(SEXP netSEXP, SEXP xSEXP) {
+List train(List net, NumericMatrix x, bool stats, RObject progress, double progressInterval, Nullable< List > convergence, bool activeSet, bool batch, int batchSize, bool speculative, int threads, bool deferred);
+RcppExport SEXP _rART_train(SEXP netSEXP, SEXP xSEXP, SEXP statsSEXP, SEXP progressSEXP, SEXP progressIntervalSEXP, SEXP convergenceSEXP, SEXP activeSetSEXP, SEXP batchSEXP, SEXP batchSizeSEXP, SEXP speculativeSEXP, SEXP threadsSEXP, SEXP deferredSEXP) {
 BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
     Rcpp::RNGScope rcpp_rngScope_gen;
     Rcpp::traits::input_parameter< List >::type net(netSEXP);
     Rcpp::traits::input_parameter< NumericMatrix >::type x(xSEXP);
-    train(net, x);
-    return R_NilValue;
+    Rcpp::traits::input_parameter< bool >::type stats(statsSEXP);
+    Rcpp::traits::input_parameter< RObject >::type progress(progressSEXP);
+    Rcpp::traits::input_parameter< double >::type progressInterval(progressIntervalSEXP);
+    Rcpp::traits::input_parameter< Nullable< List > >::type convergence(convergenceSEXP);
+    Rcpp::traits::input_parameter< bool >::type activeSet(activeSetSEXP);
+    Rcpp::traits::input_parameter< bool >::type batch(batchSEXP);
+    Rcpp::traits::input_parameter< int >::type batchSize(batchSizeSEXP);
+    Rcpp::traits::input_parameter< bool >::type speculative(speculativeSEXP);
+    Rcpp::traits::input_parameter< int >::type threads(threadsSEXP);
+    Rcpp::traits::input_parameter< bool >::type deferred(deferredSEXP);
+    rcpp_result_gen = Rcpp::wrap(train(net, x, stats, progress, progressInterval, convergence, activeSet, batch, batchSize, speculative, threads, deferred));
+    return rcpp_result_gen;
+END_RCPP
+}
+// trainFile
+List trainFile(List net, std::string file, int chunkSize, bool stats, RObject progress, double progressInterval, Nullable< List > convergence, bool activeSet);
+RcppExport SEXP _rART_trainFile(SEXP netSEXP, SEXP fileSEXP, SEXP chunkSizeSEXP, SEXP statsSEXP, SEXP progressSEXP, SEXP progressIntervalSEXP, SEXP convergenceSEXP, SEXP activeSetSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< List >::type net(netSEXP);
+    Rcpp::traits::input_parameter< std::string >::type file(fileSEXP);
+    Rcpp::traits::input_parameter< int >::type chunkSize(chunkSizeSEXP);
+    Rcpp::traits::input_parameter< bool >::type stats(statsSEXP);
+    Rcpp::traits::input_parameter< RObject >::type progress(progressSEXP);
+    Rcpp::traits::input_parameter< double >::type progressInterval(progressIntervalSEXP);
+    Rcpp::traits::input_parameter< Nullable< List > >::type convergence(convergenceSEXP);
+    Rcpp::traits::input_parameter< bool >::type activeSet(activeSetSEXP);
+    rcpp_result_gen = Rcpp::wrap(trainFile(net, file, chunkSize, stats, progress, progressInterval, convergence, activeSet));
+    return rcpp_result_gen;
+END_RCPP
+}
+// trainSharded
+List trainSharded(List net, NumericMatrix x, int shards, int threads, bool compare, Nullable< List > convergence);
+RcppExport SEXP _rART_trainSharded(SEXP netSEXP, SEXP xSEXP, SEXP shardsSEXP, SEXP threadsSEXP, SEXP compareSEXP, SEXP convergenceSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< List >::type net(netSEXP);
+    Rcpp::traits::input_parameter< NumericMatrix >::type x(xSEXP);
+    Rcpp::traits::input_parameter< int >::type shards(shardsSEXP);
+    Rcpp::traits::input_parameter< int >::type threads(threadsSEXP);
+    Rcpp::traits::input_parameter< bool >::type compare(compareSEXP);
+    Rcpp::traits::input_parameter< Nullable< List > >::type convergence(convergenceSEXP);
+    rcpp_result_gen = Rcpp::wrap(trainSharded(net, x, shards, threads, compare, convergence));
+    return rcpp_result_gen;
+END_RCPP
+}
+// partialTrain
+List partialTrain(List net, NumericMatrix x);
+RcppExport SEXP _rART_partialTrain(SEXP netSEXP, SEXP xSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< List >::type net(netSEXP);
+    Rcpp::traits::input_parameter< NumericMatrix >::type x(xSEXP);
+    rcpp_result_gen = Rcpp::wrap(partialTrain(net, x));
+    return rcpp_result_gen;
 END_RCPP
 }
 // predict
-List predict(List net, int id, NumericMatrix x);
-RcppExport SEXP _rART_predict(SEXP netSEXP, SEXP idSEXP, SEXP xSEXP) {
+List predict(List net, int id, NumericMatrix x, bool stats);
+RcppExport SEXP _rART_predict(SEXP netSEXP, SEXP idSEXP, SEXP xSEXP, SEXP statsSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::RNGScope rcpp_rngScope_gen;
     Rcpp::traits::input_parameter< List >::type net(netSEXP);
     Rcpp::traits::input_parameter< int >::type id(idSEXP);
     Rcpp::traits::input_parameter< NumericMatrix >::type x(xSEXP);
-    rcpp_result_gen = Rcpp::wrap(predict(net, id, x));
+    Rcpp::traits::input_parameter< bool >::type stats(statsSEXP);
+    rcpp_result_gen = Rcpp::wrap(predict(net, id, x, stats));
+    return rcpp_result_gen;
+END_RCPP
+}
+// predictHierarchy
+List predictHierarchy(List net, NumericMatrix x, int width, bool stats);
+RcppExport SEXP _rART_predictHierarchy(SEXP netSEXP, SEXP xSEXP, SEXP widthSEXP, SEXP statsSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< List >::type net(netSEXP);
+    Rcpp::traits::input_parameter< NumericMatrix >::type x(xSEXP);
+    Rcpp::traits::input_parameter< int >::type width(widthSEXP);
+    Rcpp::traits::input_parameter< bool >::type stats(statsSEXP);
+    rcpp_result_gen = Rcpp::wrap(predictHierarchy(net, x, width, stats));
     return rcpp_result_gen;
 END_RCPP
 }
@@ -68,21 +140,58 @@ BEGIN_RCPP
 END_RCPP
 }
 // trainARTMAP
-void trainARTMAP(List net, NumericMatrix x, Nullable< NumericVector > vTarget, Nullable< NumericMatrix > mTarget);
-RcppExport SEXP _rART_trainARTMAP(SEXP netSEXP, SEXP xSEXP, SEXP vTargetSEXP, SEXP mTargetSEXP) {
+List trainARTMAP(List net, NumericMatrix x, Nullable< NumericVector > vTarget, Nullable< NumericMatrix > mTarget, bool stats, RObject progress, double progressInterval, Nullable< List > convergence);
+RcppExport SEXP _rART_trainARTMAP(SEXP netSEXP, SEXP xSEXP, SEXP vTargetSEXP, SEXP mTargetSEXP, SEXP statsSEXP, SEXP progressSEXP, SEXP progressIntervalSEXP, SEXP convergenceSEXP) {
 BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
     Rcpp::RNGScope rcpp_rngScope_gen;
     Rcpp::traits::input_parameter< List >::type net(netSEXP);
     Rcpp::traits::input_parameter< NumericMatrix >::type x(xSEXP);
     Rcpp::traits::input_parameter< Nullable< NumericVector > >::type vTarget(vTargetSEXP);
     Rcpp::traits::input_parameter< Nullable< NumericMatrix > >::type mTarget(mTargetSEXP);
-    trainARTMAP(net, x, vTarget, mTarget);
-    return R_NilValue;
+    Rcpp::traits::input_parameter< bool >::type stats(statsSEXP);
+    Rcpp::traits::input_parameter< RObject >::type progress(progressSEXP);
+    Rcpp::traits::input_parameter< double >::type progressInterval(progressIntervalSEXP);
+    Rcpp::traits::input_parameter< Nullable< List > >::type convergence(convergenceSEXP);
+    rcpp_result_gen = Rcpp::wrap(trainARTMAP(net, x, vTarget, mTarget, stats, progress, progressInterval, convergence));
+    return rcpp_result_gen;
+END_RCPP
+}
+// trainARTMAPFile
+List trainARTMAPFile(List net, std::string file, int targetColumns, int chunkSize, bool stats, RObject progress, double progressInterval, Nullable< List > convergence);
+RcppExport SEXP _rART_trainARTMAPFile(SEXP netSEXP, SEXP fileSEXP, SEXP targetColumnsSEXP, SEXP chunkSizeSEXP, SEXP statsSEXP, SEXP progressSEXP, SEXP progressIntervalSEXP, SEXP convergenceSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< List >::type net(netSEXP);
+    Rcpp::traits::input_parameter< std::string >::type file(fileSEXP);
+    Rcpp::traits::input_parameter< int >::type targetColumns(targetColumnsSEXP);
+    Rcpp::traits::input_parameter< int >::type chunkSize(chunkSizeSEXP);
+    Rcpp::traits::input_parameter< bool >::type stats(statsSEXP);
+    Rcpp::traits::input_parameter< RObject >::type progress(progressSEXP);
+    Rcpp::traits::input_parameter< double >::type progressInterval(progressIntervalSEXP);
+    Rcpp::traits::input_parameter< Nullable< List > >::type convergence(convergenceSEXP);
+    rcpp_result_gen = Rcpp::wrap(trainARTMAPFile(net, file, targetColumns, chunkSize, stats, progress, progressInterval, convergence));
+    return rcpp_result_gen;
+END_RCPP
+}
+// partialTrainARTMAP
+List partialTrainARTMAP(List net, NumericMatrix x, Nullable< NumericVector > vTarget, Nullable< NumericMatrix > mTarget);
+RcppExport SEXP _rART_partialTrainARTMAP(SEXP netSEXP, SEXP xSEXP, SEXP vTargetSEXP, SEXP mTargetSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< List >::type net(netSEXP);
+    Rcpp::traits::input_parameter< NumericMatrix >::type x(xSEXP);
+    Rcpp::traits::input_parameter< Nullable< NumericVector > >::type vTarget(vTargetSEXP);
+    Rcpp::traits::input_parameter< Nullable< NumericMatrix > >::type mTarget(mTargetSEXP);
+    rcpp_result_gen = Rcpp::wrap(partialTrainARTMAP(net, x, vTarget, mTarget));
+    return rcpp_result_gen;
 END_RCPP
 }
 // predictARTMAP
-List predictARTMAP(List net, NumericMatrix x, Nullable< NumericVector > vTarget, Nullable< NumericMatrix > mTarget);
-RcppExport SEXP _rART_predictARTMAP(SEXP netSEXP, SEXP xSEXP, SEXP vTargetSEXP, SEXP mTargetSEXP) {
+List predictARTMAP(List net, NumericMatrix x, Nullable< NumericVector > vTarget, Nullable< NumericMatrix > mTarget, bool stats);
+RcppExport SEXP _rART_predictARTMAP(SEXP netSEXP, SEXP xSEXP, SEXP vTargetSEXP, SEXP mTargetSEXP, SEXP statsSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::RNGScope rcpp_rngScope_gen;
@@ -90,7 +199,8 @@ BEGIN_RCPP
     Rcpp::traits::input_parameter< NumericMatrix >::type x(xSEXP);
     Rcpp::traits::input_parameter< Nullable< NumericVector > >::type vTarget(vTargetSEXP);
     Rcpp::traits::input_parameter< Nullable< NumericMatrix > >::type mTarget(mTargetSEXP);
-    rcpp_result_gen = Rcpp::wrap(predictARTMAP(net, x, vTarget, mTarget));
+    Rcpp::traits::input_parameter< bool >::type stats(statsSEXP);
+    rcpp_result_gen = Rcpp::wrap(predictARTMAP(net, x, vTarget, mTarget, stats));
     return rcpp_result_gen;
 END_RCPP
 }
@@ -114,27 +224,64 @@ BEGIN_RCPP
 END_RCPP
 }
 // topoTrain
-void topoTrain(List net, NumericMatrix x, Nullable< NumericVector > labels);
-RcppExport SEXP _rART_topoTrain(SEXP netSEXP, SEXP xSEXP, SEXP labelsSEXP) {
+List topoTrain(List net, NumericMatrix x, Nullable< NumericVector > labels, bool staged, bool stats, RObject progress, double progressInterval, Nullable< List > convergence);
+RcppExport SEXP _rART_topoTrain(SEXP netSEXP, SEXP xSEXP, SEXP labelsSEXP, SEXP stagedSEXP, SEXP statsSEXP, SEXP progressSEXP, SEXP progressIntervalSEXP, SEXP convergenceSEXP) {
 BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
     Rcpp::RNGScope rcpp_rngScope_gen;
     Rcpp::traits::input_parameter< List >::type net(netSEXP);
     Rcpp::traits::input_parameter< NumericMatrix >::type x(xSEXP);
     Rcpp::traits::input_parameter< Nullable< NumericVector > >::type labels(labelsSEXP);
-    topoTrain(net, x, labels);
-    return R_NilValue;
+    Rcpp::traits::input_parameter< bool >::type staged(stagedSEXP);
+    Rcpp::traits::input_parameter< bool >::type stats(statsSEXP);
+    Rcpp::traits::input_parameter< RObject >::type progress(progressSEXP);
+    Rcpp::traits::input_parameter< double >::type progressInterval(progressIntervalSEXP);
+    Rcpp::traits::input_parameter< Nullable< List > >::type convergence(convergenceSEXP);
+    rcpp_result_gen = Rcpp::wrap(topoTrain(net, x, labels, staged, stats, progress, progressInterval, convergence));
+    return rcpp_result_gen;
+END_RCPP
+}
+// topoTrainFile
+List topoTrainFile(List net, std::string file, int chunkSize, bool staged, bool stats, RObject progress, double progressInterval, Nullable< List > convergence);
+RcppExport SEXP _rART_topoTrainFile(SEXP netSEXP, SEXP fileSEXP, SEXP chunkSizeSEXP, SEXP stagedSEXP, SEXP statsSEXP, SEXP progressSEXP, SEXP progressIntervalSEXP, SEXP convergenceSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< List >::type net(netSEXP);
+    Rcpp::traits::input_parameter< std::string >::type file(fileSEXP);
+    Rcpp::traits::input_parameter< int >::type chunkSize(chunkSizeSEXP);
+    Rcpp::traits::input_parameter< bool >::type staged(stagedSEXP);
+    Rcpp::traits::input_parameter< bool >::type stats(statsSEXP);
+    Rcpp::traits::input_parameter< RObject >::type progress(progressSEXP);
+    Rcpp::traits::input_parameter< double >::type progressInterval(progressIntervalSEXP);
+    Rcpp::traits::input_parameter< Nullable< List > >::type convergence(convergenceSEXP);
+    rcpp_result_gen = Rcpp::wrap(topoTrainFile(net, file, chunkSize, staged, stats, progress, progressInterval, convergence));
+    return rcpp_result_gen;
+END_RCPP
+}
+// topoPartialTrain
+List topoPartialTrain(List net, NumericMatrix x);
+RcppExport SEXP _rART_topoPartialTrain(SEXP netSEXP, SEXP xSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< List >::type net(netSEXP);
+    Rcpp::traits::input_parameter< NumericMatrix >::type x(xSEXP);
+    rcpp_result_gen = Rcpp::wrap(topoPartialTrain(net, x));
+    return rcpp_result_gen;
 END_RCPP
 }
 // topoPredict
-List topoPredict(List net, int id, NumericMatrix x);
-RcppExport SEXP _rART_topoPredict(SEXP netSEXP, SEXP idSEXP, SEXP xSEXP) {
+List topoPredict(List net, int id, NumericMatrix x, bool stats);
+RcppExport SEXP _rART_topoPredict(SEXP netSEXP, SEXP idSEXP, SEXP xSEXP, SEXP statsSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::RNGScope rcpp_rngScope_gen;
     Rcpp::traits::input_parameter< List >::type net(netSEXP);
     Rcpp::traits::input_parameter< int >::type id(idSEXP);
     Rcpp::traits::input_parameter< NumericMatrix >::type x(xSEXP);
-    rcpp_result_gen = Rcpp::wrap(topoPredict(net, id, x));
+    Rcpp::traits::input_parameter< bool >::type stats(statsSEXP);
+    rcpp_result_gen = Rcpp::wrap(topoPredict(net, id, x, stats));
     return rcpp_result_gen;
 END_RCPP
 }
@@ -148,6 +295,21 @@ BEGIN_RCPP
     return R_NilValue;
 END_RCPP
 }
+// readData
+NumericMatrix readData(std::string file, Nullable< NumericVector > minimum, Nullable< NumericVector > maximum, bool normalize, int threads);
+RcppExport SEXP _rART_readData(SEXP fileSEXP, SEXP minimumSEXP, SEXP maximumSEXP, SEXP normalizeSEXP, SEXP threadsSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< std::string >::type file(fileSEXP);
+    Rcpp::traits::input_parameter< Nullable< NumericVector > >::type minimum(minimumSEXP);
+    Rcpp::traits::input_parameter< Nullable< NumericVector > >::type maximum(maximumSEXP);
+    Rcpp::traits::input_parameter< bool >::type normalize(normalizeSEXP);
+    Rcpp::traits::input_parameter< int >::type threads(threadsSEXP);
+    rcpp_result_gen = Rcpp::wrap(readData(file, minimum, maximum, normalize, threads));
+    return rcpp_result_gen;
+END_RCPP
+}
 // checkFuzzyBounds
 void checkFuzzyBounds(List net);
 RcppExport SEXP _rART_checkFuzzyBounds(SEXP netSEXP) {
@@ -168,6 +330,28 @@ BEGIN_RCPP
     return R_NilValue;
 END_RCPP
 }
+// saveModel
+void saveModel(List net, std::string file);
+RcppExport SEXP _rART_saveModel(SEXP netSEXP, SEXP fileSEXP) {
+BEGIN_RCPP
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< List >::type net(netSEXP);
+    Rcpp::traits::input_parameter< std::string >::type file(fileSEXP);
+    saveModel(net, file);
+    return R_NilValue;
+END_RCPP
+}
+// loadModel
+List loadModel(std::string file);
+RcppExport SEXP _rART_loadModel(SEXP fileSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< std::string >::type file(fileSEXP);
+    rcpp_result_gen = Rcpp::wrap(loadModel(file));
+    return rcpp_result_gen;
+END_RCPP
+}
 // linkClusters
 List linkClusters(IntegerVector edges, IntegerVector nodes);
 RcppExport SEXP _rART_linkClusters(SEXP edgesSEXP, SEXP nodesSEXP) {
@@ -227,27 +411,55 @@ BEGIN_RCPP
     return rcpp_result_gen;
 END_RCPP
 }
+// compact
+List compact(List net, int minCounter, Nullable< NumericMatrix > x, Nullable< NumericMatrix > target, bool relearn, bool order);
+RcppExport SEXP _rART_compact(SEXP netSEXP, SEXP minCounterSEXP, SEXP xSEXP, SEXP targetSEXP, SEXP relearnSEXP, SEXP orderSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< List >::type net(netSEXP);
+    Rcpp::traits::input_parameter< int >::type minCounter(minCounterSEXP);
+    Rcpp::traits::input_parameter< Nullable< NumericMatrix > >::type x(xSEXP);
+    Rcpp::traits::input_parameter< Nullable< NumericMatrix > >::type target(targetSEXP);
+    Rcpp::traits::input_parameter< bool >::type relearn(relearnSEXP);
+    Rcpp::traits::input_parameter< bool >::type order(orderSEXP);
+    rcpp_result_gen = Rcpp::wrap(compact(net, minCounter, x, target, relearn, order));
+    return rcpp_result_gen;
+END_RCPP
+}
 
 RcppExport SEXP run_testthat_tests(SEXP);
 
 static const R_CallMethodDef CallEntries[] = {
-    {"_rART_train", (DL_FUNC) &_rART_train, 2},
-    {"_rART_predict", (DL_FUNC) &_rART_predict, 3},
+    {"_rART_train", (DL_FUNC) &_rART_train, 12},
+    {"_rART_trainFile", (DL_FUNC) &_rART_trainFile, 8},
+    {"_rART_trainSharded", (DL_FUNC) &_rART_trainSharded, 6},
+    {"_rART_partialTrain", (DL_FUNC) &_rART_partialTrain, 2},
+    {"_rART_predict", (DL_FUNC) &_rART_predict, 4},
+    {"_rART_predictHierarchy", (DL_FUNC) &_rART_predictHierarchy, 4},
     {"_rART_newART", (DL_FUNC) &_rART_newART, 6},
     {"_rART_newARTMAP", (DL_FUNC) &_rART_newARTMAP, 7},
-    {"_rART_trainARTMAP", (DL_FUNC) &_rART_trainARTMAP, 4},
-    {"_rART_predictARTMAP", (DL_FUNC) &_rART_predictARTMAP, 4},
+    {"_rART_trainARTMAP", (DL_FUNC) &_rART_trainARTMAP, 8},
+    {"_rART_trainARTMAPFile", (DL_FUNC) &_rART_trainARTMAPFile, 8},
+    {"_rART_partialTrainARTMAP", (DL_FUNC) &_rART_partialTrainARTMAP, 4},
+    {"_rART_predictARTMAP", (DL_FUNC) &_rART_predictARTMAP, 5},
     {"_rART_TopoART", (DL_FUNC) &_rART_TopoART, 9},
-    {"_rART_topoTrain", (DL_FUNC) &_rART_topoTrain, 3},
-    {"_rART_topoPredict", (DL_FUNC) &_rART_topoPredict, 3},
+    {"_rART_topoTrain", (DL_FUNC) &_rART_topoTrain, 8},
+    {"_rART_topoTrainFile", (DL_FUNC) &_rART_topoTrainFile, 8},
+    {"_rART_topoPartialTrain", (DL_FUNC) &_rART_topoPartialTrain, 2},
+    {"_rART_topoPredict", (DL_FUNC) &_rART_topoPredict, 4},
     {"_rART_checkART1Bounds", (DL_FUNC) &_rART_checkART1Bounds, 1},
+    {"_rART_readData", (DL_FUNC) &_rART_readData, 5},
     {"_rART_checkFuzzyBounds", (DL_FUNC) &_rART_checkFuzzyBounds, 1},
     {"_rART_checkHypersphereBounds", (DL_FUNC) &_rART_checkHypersphereBounds, 1},
+    {"_rART_saveModel", (DL_FUNC) &_rART_saveModel, 2},
+    {"_rART_loadModel", (DL_FUNC) &_rART_loadModel, 1},
     {"_rART_linkClusters", (DL_FUNC) &_rART_linkClusters, 2},
     {"_rART_createDummyCodeMap", (DL_FUNC) &_rART_createDummyCodeMap, 1},
     {"_rART_encodeNumericLabel", (DL_FUNC) &_rART_encodeNumericLabel, 2},
     {"_rART_encodeStringLabel", (DL_FUNC) &_rART_encodeStringLabel, 2},
     {"_rART_decode", (DL_FUNC) &_rART_decode, 2},
+    {"_rART_compact", (DL_FUNC) &_rART_compact, 6},
     {"run_testthat_tests", (DL_FUNC) &run_testthat_tests, 1},
     {NULL, NULL, 0}
 };
@@ -0,0 +1,1536 @@
+/****************************************************************************
+ *
+ *  core-art.cpp
+ *  ART on native network state
+ *
+ ****************************************************************************/
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include "core.h"
+
+namespace core {
+
+  Module::Module() : id( 0 ), weightDimension( 0 ), capacity( 100 ), numCategories( 0 ), rows( 0 ),
+                     alpha( ALPHA ), epsilon( EPSILON ), rho( 0.75 ), beta( 1.0 ), R_bar( 0 ), hasR_bar( false ),
+                     Jmax( 1, -1 ), changes( 0 ), changed( 0 ), weightDelta( 0 ), beta1( 1.0 ), beta2( 0.6 ),
+                     phi( 0 ) {}
+
+  // init: allocate the storage for capacity categories of the weight dimension
+  void Module::init( int weightDimension ){
+    this->weightDimension = weightDimension;
+    clearBlocks();
+    rows = capacity;
+    w.assign( (size_t)rows * weightDimension, 0 );
+    counter.assign( rows, 0 );
+    change.assign( rows, 0 );
+    n.assign( rows, 0 );
+  }
+
+  // syncBlocks: copy the categories added since the last activation to the blocks
+  void Module::syncBlocks() const {
+    if ( blocks.dimension != weightDimension || blocks.size > numCategories ){
+      blocks.clear();
+      blocks.dimension = weightDimension;
+    }
+    if ( blocks.size < numCategories ){
+      int L = CategoryBlocks::LANES;
+      blocks.v.resize( (size_t)( numCategories + L - 1 )/L * weightDimension * L, 0 );
+      for ( int k = blocks.size; k < numCategories; k++ ){
+        blocks.set( k, weight( k ) );
+      }
+      blocks.size = numCategories;
+    }
+  }
+
+  // syncEnvelopes: cover the categories added since the last search and recompute the blocks
+  // with a changed category
+  void Module::syncEnvelopes( Rule rule ) const {
+    const int S = CategoryEnvelopes::SIZE;
+    CategoryEnvelopes &e = envelopes;
+    int d = weightDimension;
+    if ( e.dimension != d || e.size > numCategories ){
+      e.clear();
+      e.dimension = d;
+    }
+    if ( e.size < numCategories ){
+      int first = e.size/S;   // the block of the first category added
+      e.size = numCategories;
+      int blocks = e.blocks();
+      e.hi.resize( (size_t)blocks * d );
+      e.lo.resize( (size_t)blocks * d );
+      e.centre.resize( (size_t)blocks * d );
+      e.radius.resize( blocks );
+      e.bounded.resize( blocks );
+      e.stale.resize( blocks );
+      for ( int b = first; b < blocks; b++ ){
+        e.stale[b] = 1;
+      }
+    }
+    for ( int b = 0; b < e.blocks(); b++ ){
+      if ( !e.stale[b] ){
+        continue;
+      }
+      e.stale[b] = 0;
+      double *hi = &e.hi[(size_t)b * d];
+      double *lo = &e.lo[(size_t)b * d];
+      int last = std::min( ( b + 1 ) * S, numCategories );
+      bool bounded = true;
+      for ( int i = 0; i < d; i++ ){
+        hi[i] = -std::numeric_limits< double >::infinity();
+        lo[i] = std::numeric_limits< double >::infinity();
+      }
+      for ( int k = b * S; k < last; k++ ){
+        const double *w = weight( k );
+        for ( int i = 0; i < d; i++ ){
+          bounded = bounded && std::isfinite( w[i] );
+          hi[i] = std::max( hi[i], w[i] );
+          lo[i] = std::min( lo[i], w[i] );
+        }
+      }
+      e.bounded[b] = bounded;
+      if ( rule == RULE_HYPERSPHERE && bounded ){
+        // the ball around the middle of the box of the centres
+        double *c = &e.centre[(size_t)b * d];
+        for ( int i = 0; i < d - 1; i++ ){
+          c[i] = lo[i] + ( hi[i] - lo[i] )/2;
+        }
+        double r = 0;
+        for ( int k = b * S; k < last; k++ ){
+          r = std::max( r, hypersphere::norm( weight( k ), c, d - 1 ) );
+        }
+        e.radius[b] = r;
+      }
+    }
+  }
+
+  void CategoryBlocks::set( int k, const double *w ){
+    double *b = &v[(size_t)( k/LANES ) * dimension * LANES + k % LANES];
+    for ( int i = 0; i < dimension; i++ ){
+      b[i * LANES] = w[i];
+    }
+  }
+
+  // grow: the module runs out of categories, so add capacity more
+  void Module::grow(){
+    rows += capacity;
+    w.resize( (size_t)rows * weightDimension, 0 );
+    counter.resize( rows, 0 );
+    change.resize( rows, 0 );
+    n.resize( rows, 0 );
+  }
+
+  // trim: shrink the storage to the categories created
+  void Module::trim(){
+    rows = numCategories;
+    w.resize( (size_t)rows * weightDimension );
+    counter.resize( rows );
+    change.resize( rows );
+    n.resize( rows );
+  }
+
+  Mapfield::Mapfield() : id( 0 ), capacity( 50 ), alpha( ALPHA ), epsilon( EPSILON ), rho( 0.75 ), beta( 1.0 ),
+                         changes( 0 ), numCategories( 0 ), rows( 0 ), cols( 0 ), numCategories_a( 0 ), numCategories_b( 0 ),
+                         weightDimension( 0 ) {}
+
+  Network::Network() : type( NETWORK_ART ), rule( RULE_FUZZY ), dimension( 0 ), epochs( 0 ), maxEpochs( 20 ),
+                       initialized( false ), tau( 100 ), tauCounter( 0 ), simplified( false ), stats( NULL ),
+                       progress( NULL ), stopReason( STOP_NONE ) {}
+
+  ModuleStats::ModuleStats() : searches( 0 ), vigilanceFailures( 0 ), matchTrackingResets( 0 ), newCategories( 0 ),
+                               removals( 0 ), blocksVisited( 0 ), blocksMatchPruned( 0 ), blocksActivationPruned( 0 ),
+                               activationTime( 0 ), searchTime( 0 ), updateTime( 0 ) {}
+
+  // search: count a search that examined depth candidates, of which failures failed the vigilance test
+  void ModuleStats::search( int depth, int failures ){
+    searches++;
+    if ( depth >= (int)this->depth.size() ){
+      this->depth.resize( depth + 1, 0 );
+    }
+    this->depth[depth]++;
+    vigilanceFailures += failures;
+  }
+
+  namespace ART {
+
+    // rho: If there is just one module, then return the rho as is. If there are more than
+    // one module in the hierarchy, then the next module in the hierarchy will have
+    // rho = 2*rho - 1 with rho being the vigilance value of the previous module.
+    double rho( double rho, int moduleId ){
+      for ( int i = 1; i <= moduleId; i++ ){
+        rho = rho*2 - 1;
+      }
+      return rho;
+    }
+
+    Module module( int id, double vigilance, double learningRate, int categorySize ){
+      Module module;
+      module.id = id;
+      module.capacity = categorySize;
+      module.rho = vigilance;
+      module.beta = learningRate;
+      return module;
+    }
+
+    Network create( Rule rule, int dimension, int num, double vigilance, double learningRate, int categorySize, int maxEpochs ){
+      if ( vigilance < 0.0 || vigilance > 1.0 ){
+        throw std::invalid_argument( "The vigilance value must be between 0 and 1.0." );
+      }
+      if ( num < 1 ){
+        throw std::invalid_argument( "The num value must be greater than 0." );
+      }
+      if ( categorySize < 1 ){
+        throw std::invalid_argument( "The categorySize value must be greater than 0." );
+      }
+      if ( maxEpochs < 1 ){
+        throw std::invalid_argument( "The maxEpochs value must be greater than 0." );
+      }
+      if ( dimension < 1 ){
+        throw std::invalid_argument( "The dimension value must be greater than 0." );
+      }
+
+      Network net;
+      net.type = NETWORK_ART;
+      net.rule = rule;
+      net.dimension = dimension;
+      net.maxEpochs = maxEpochs;
+      for ( int i = 0; i < num; i++ ){
+        if ( i > 0 ){
+          vigilance = rho( vigilance, i );
+        }
+        if ( vigilance > 0 ){
+          net.modules.push_back( module( i, vigilance, learningRate, categorySize ) );
+        }
+      }
+      return net;
+    }
+
+    void init( Network &net ){
+      for ( Module &module : net.modules ){
+        module.init( weightDimension( net.rule, net.dimension ) );
+      }
+      net.initialized = true;
+    }
+
+    int moduleChange( const Module &module ){
+      int s = 0;
+      for ( int c : module.change ){
+        s += c;
+      }
+      return s;
+    }
+
+    // totalChange: the changes of the current epoch in all modules, from the epoch counters
+    int totalChange( const Network &net ){
+      int s = 0;
+      for ( const Module &module : net.modules ){
+        s += module.changes;
+      }
+      return s;
+    }
+
+    void changeReset( Module &module ){
+      std::fill( module.change.begin(), module.change.end(), 0 );
+      module.changes = 0;
+      module.changed = 0;
+      module.weightDelta = 0;
+    }
+
+    // countChange: count a change of category k in the change vector and the epoch counters
+    static void countChange( Module &module, int k ){
+      if ( module.change[k]++ == 0 ){
+        module.changed++;
+      }
+      module.changes++;
+    }
+
+    void counterReset( Module &module ){
+      std::fill( module.counter.begin(), module.counter.end(), 0 );
+    }
+
+    void activation( const Network &net, const Module &module, const double *x, std::vector< double > &a ){
+      int nc = module.numCategories;
+      a.resize( nc );
+      const Kernels &f = kernels( net.rule, module.weightDimension );
+      if ( !module.blocked() ){
+        for ( int k = 0; k < nc; k++ ){
+          a[k] = f.activation( module, x, module.weight( k ) );
+        }
+        return;
+      }
+      const int L = CategoryBlocks::LANES;
+      module.syncBlocks();
+      int full = nc/L;
+      for ( int b = 0; b < full; b++ ){
+        f.blockActivation( module, x, module.blocks.block( b ), &a[b * L] );
+      }
+      if ( full * L < nc ){
+        double last[L];
+        f.blockActivation( module, x, module.blocks.block( full ), last );
+        std::copy( last, last + nc - full * L, &a[full * L] );
+      }
+    }
+
+    // weightUpdate: update the weight of a category and return the sum of the absolute changes
+    double weightUpdate( const Network &net, Module &module, int weightIndex, const double *x, double learningRate ){
+      double s = core::weightUpdate( net.rule, module, learningRate, x, module.weight( weightIndex ) );
+      module.updateBlock( weightIndex );
+      module.weightDelta += s;
+      if ( s > 0.0000001 ){
+        countChange( module, weightIndex );
+      }
+      return s;
+    }
+
+    void newCategory( const Network &net, Module &module, const double *x ){
+      int newCategoryIndex = module.numCategories;
+      if ( newCategoryIndex == module.rows ){
+        // reached the max capacity, so add more rows
+        module.grow();
+      }
+      core::newWeight( net.rule, module, x, module.weight( newCategoryIndex ) );
+      module.writes.touch( newCategoryIndex );
+      module.counter[newCategoryIndex]++;
+      countChange( module, newCategoryIndex );
+      module.numCategories = newCategoryIndex + 1;
+      module.Jmax[0] = newCategoryIndex;
+      if ( ModuleStats *s = net.moduleStats( module.id ) ){
+        s->newCategories++;
+      }
+    }
+
+    namespace {
+
+      // the modules with fewer categories are searched in the sorted order
+      const int BOUNDED_SEARCH = 4 * CategoryEnvelopes::SIZE;
+
+      // better: the order of the sorted search, descending activations with ties to the lower index
+      inline bool better( double T1, int k1, double T2, int k2 ){
+        return T1 > T2 || ( T1 == T2 && k1 < k2 );
+      }
+
+      // boundedSearch: the category the sorted search of learn and classify resonates with, found
+      // by visiting the blocks of categories (see CategoryEnvelopes) in the order of their bounds.
+      // The blocks whose match bound is below the vigilance are skipped, and the search stops at
+      // the first block whose activation bound is below the best category that passed. Returns
+      // -1 if no category passes, and -2 if the module is too small or an activation is not a
+      // number, so the sorted search has to decide. With stats, the search is counted with the
+      // categories evaluated as its depth and the blocks visited and pruned.
+      int boundedSearch( const Network &net, const Module &module, const double *x, ModuleStats *s, PhaseTimer &timer ){
+        const int S = CategoryEnvelopes::SIZE;
+        const int L = CategoryBlocks::LANES;
+        int nc = module.numCategories;
+        if ( nc < BOUNDED_SEARCH ){
+          return -2;
+        }
+        module.syncEnvelopes( net.rule );
+        if ( module.blocked() ){
+          module.syncBlocks();
+        }
+        int nb = module.envelopes.blocks();
+        int n = net.rule == RULE_FUZZY ? module.weightDimension : module.weightDimension/2;
+        double sx = 0;
+        for ( int i = 0; i < n && net.rule != RULE_HYPERSPHERE; i++ ){
+          sx += std::isnan( x[i] ) ? 0.0 : x[i];
+        }
+        std::vector< double > T_b( nb ), m_b( nb );
+        for ( int b = 0; b < nb; b++ ){
+          blockBound( net.rule, module, x, sx, b, T_b[b], m_b[b] );
+          if ( std::isnan( T_b[b] ) || std::isnan( m_b[b] ) ){
+            T_b[b] = m_b[b] = std::numeric_limits< double >::infinity();
+          }
+        }
+        std::vector< int > order;
+        sortIndex( T_b, order );
+        double boundTime = timer.lap();
+
+        const Kernels &f = kernels( net.rule, module.weightDimension );
+        Vigilance vigilance( net.rule, module, x );
+        int J = -1;
+        double T_J = 0;
+        double a[S];
+        int evaluated = 0;
+        int failures = 0;
+        int visited = 0;
+        int matchPruned = 0;
+        for ( int b : order ){
+          if ( J != -1 && T_b[b] < T_J ){
+            break;
+          }
+          if ( m_b[b] < module.rho ){
+            matchPruned++;
+            continue;
+          }
+          visited++;
+          int first = b * S;
+          int size = std::min( S, nc - first );
+          if ( module.blocked() ){
+            for ( int l = 0; l < size; l += L ){
+              f.blockActivation( module, x, module.blocks.block( ( first + l )/L ), &a[l] );
+            }
+          }
+          else{
+            for ( int l = 0; l < size; l++ ){
+              a[l] = f.activation( module, x, module.weight( first + l ) );
+            }
+          }
+          evaluated += size;
+          for ( int l = 0; l < size; l++ ){
+            int k = first + l;
+            if ( std::isnan( a[l] ) ){
+              if ( s ){
+                // the time is spent all the same; the sorted search counts the search
+                s->activationTime += boundTime + timer.lap();
+              }
+              return -2;
+            }
+            if ( J == -1 || better( a[l], k, T_J, J ) ){
+              if ( vigilance.passes( module.weight( k ) ) ){
+                J = k;
+                T_J = a[l];
+              }
+              else{
+                failures++;
+              }
+            }
+          }
+        }
+        if ( s ){
+          s->search( evaluated, failures );
+          s->blocksVisited += visited;
+          s->blocksMatchPruned += matchPruned;
+          s->blocksActivationPruned += nb - visited - matchPruned;
+          s->activationTime += boundTime;
+          s->searchTime += timer.lap();
+        }
+        return J;
+      }
+    }
+
+    void learn( Network &net, int id, const double *x ){
+      Module &module = net.modules[id];
+      ModuleStats *s = net.moduleStats( id );
+      PhaseTimer timer( s != NULL );
+
+      int nc = module.numCategories;
+      if ( nc == 0 ){
+        newCategory( net, module, x );
+        if ( s ){
+          s->search( 0, 0 );
+          s->updateTime += timer.lap();
+        }
+        return;
+      }
+
+      int J = boundedSearch( net, module, x, s, timer );
+      bool sorted = J == -2;
+      if ( sorted ){
+        J = -1;
+        std::vector< double > a;
+        std::vector< int > T_j;
+        activation( net, module, x, a );
+        sortIndex( a, T_j );
+        if ( s ){
+          s->activationTime += timer.lap();
+        }
+        Vigilance vigilance( net.rule, module, x );
+        for ( int j = 0; j < nc; j++ ){
+          if ( vigilance.passes( module.weight( T_j[j] ) ) ){
+            J = T_j[j];
+            if ( s ){
+              s->search( j + 1, j );
+              s->searchTime += timer.lap();
+            }
+            break;
+          }
+        }
+      }
+
+      if ( J != -1 ){
+        module.Jmax[0] = J;
+        weightUpdate( net, module, J, x, module.beta );
+        module.counter[J]++;
+        if ( s ){
+          s->updateTime += timer.lap();
+        }
+        if ( net.hasMoreModules( id ) ){
+          // match >= rho_a, then move up to the next module in the hierarchy
+          // the weight of this node will be the input for the next module
+          learn( net, id+1, module.weight( J ) );
+        }
+        return;
+      }
+
+      // no category passes the vigilance test; the bounded search has counted itself
+      if ( s && sorted ){
+        s->search( nc, nc );
+        s->searchTime += timer.lap();
+      }
+      newCategory( net, module, x );
+      if ( s ){
+        s->updateTime += timer.lap();
+      }
+      if ( net.hasMoreModules( id ) ){
+        learn( net, id+1, module.weight( nc ) );
+      }
+    }
+
+    // classify: the category of module id the input resonates with, or -1 if there is none
+    int classify( Network &net, int id, const double *x ){
+      // the weights are only read, so a module viewing a model file is not copied
+      const Module &module = net.modules[id];
+      ModuleStats *s = net.moduleStats( id );
+      PhaseTimer timer( s != NULL );
+
+      int category = boundedSearch( net, module, x, s, timer );
+      if ( category == -2 ){
+        category = -1;
+        std::vector< double > a;
+        std::vector< int > T_j;
+        activation( net, module, x, a );
+        sortIndex( a, T_j );
+        if ( s ){
+          s->activationTime += timer.lap();
+        }
+        int nc = module.numCategories;
+        Vigilance vigilance( net.rule, module, x );
+        int j = 0;
+        for ( ; j < nc; j++ ){
+          int J_max = T_j[j];
+          if ( vigilance.passes( module.weight( J_max ) ) ){
+            category = J_max;
+            break;
+          }
+        }
+        if ( s ){
+          s->search( category == -1 ? nc : j + 1, j );
+          s->searchTime += timer.lap();
+        }
+      }
+      net.modules[id].Jmax[0] = category;
+
+      return category;
+    }
+
+    void checkDimension( const Network &net, Rows x ){
+      if ( x.cols != net.dimension ){
+        throw std::invalid_argument( "The number of columns in the data must be the dimension of the network." );
+      }
+    }
+
+    namespace {
+
+      /* ActiveSet: the active-set epochs of train. Each row keeps the category of module 0 it
+         resonated with, the best other category that passed the vigilance test (the runner-up)
+         and its position in the log of the modified categories. In the next epoch only its last
+         category and the categories modified since are evaluated: the other categories have not
+         changed, so they fail the vigilance test again or lose to the runner-up. The choice is the
+         one of the sorted search in learn, the highest activation that passes with ties to the
+         lower index, so training is the same as without the active set. */
+      class ActiveSet {
+      public:
+        ActiveSet() : first( 0 ), previous( 0 ), pass( 0 ) {}
+        void startEpoch();
+        void learn( Network &net, long row, const double *x );
+
+      private:
+        struct Row {
+          int J;                // the category, -1 before the first epoch
+          int runnerUp;         // -1 if no other category passed
+          double T_runnerUp;
+          long stamp;           // the log position after the row was learned
+        };
+        struct Search {
+          int J;
+          int runnerUp;
+          double T_runnerUp;
+          int depth;
+          int failures;
+        };
+
+        long clock() const { return first + log.size(); }
+        bool verify( const Network &net, const Row &r, const double *x, Search &f );
+        void search( const Network &net, const double *x, Search &f );
+
+        std::vector< Row > rows;
+        std::vector< int > log;       // the categories modified, in order; log[0] is at position first
+        long first;
+        long previous;                // the log position at the start of the previous epoch
+        std::vector< long > seen;     // seen[k]: the last verify that evaluated category k
+        long pass;
+        std::vector< double > a;
+        std::vector< int > T_j;
+      };
+
+      // startEpoch: every row has been learned since the start of the previous epoch, so the
+      // older part of the log is not needed any more
+      void ActiveSet::startEpoch(){
+        if ( previous > first ){
+          log.erase( log.begin(), log.begin() + ( previous - first ) );
+          first = previous;
+        }
+        previous = clock();
+      }
+
+      // search: the sorted search of learn, which goes on past the resonant category to the runner-up
+      void ActiveSet::search( const Network &net, const double *x, Search &f ){
+        const Module &module = net.modules[0];
+        int nc = module.numCategories;
+        activation( net, module, x, a );
+        sortIndex( a, T_j );
+        f.J = -1;
+        f.runnerUp = -1;
+        f.depth = nc;
+        f.failures = 0;
+        Vigilance vigilance( net.rule, module, x );
+        for ( int j = 0; j < nc; j++ ){
+          int k = T_j[j];
+          if ( !vigilance.passes( module.weight( k ) ) ){
+            f.failures++;
+          }
+          else if ( f.J == -1 ){
+            f.J = k;
+          }
+          else{
+            f.runnerUp = k;
+            f.T_runnerUp = a[k];
+            f.depth = j + 1;
+            break;
+          }
+        }
+      }
+
+      // verify: the search of a row from its last category and the categories modified since.
+      // Returns false if a full search is needed: the log is trimmed or longer than a few epochs of
+      // changes, half of the categories have changed, the runner-up has changed or wins, or an
+      // activation is not a number.
+      bool ActiveSet::verify( const Network &net, const Row &r, const double *x, Search &f ){
+        const Module &module = net.modules[0];
+        int nc = module.numCategories;
+        if ( r.stamp < first || clock() - r.stamp > 4L * nc || std::isnan( r.T_runnerUp ) ){
+          return false;
+        }
+        seen.resize( nc, -1 );
+        pass++;
+
+        f.J = -1;
+        f.runnerUp = r.runnerUp;
+        f.T_runnerUp = r.T_runnerUp;
+        f.depth = 0;
+        f.failures = 0;
+        double T_J = 0;
+        Vigilance vigilance( net.rule, module, x );
+        for ( long i = r.stamp - first - 1; i < (long)log.size(); i++ ){
+          // the last category first, then the modified ones
+          int k = i < r.stamp - first ? r.J : log[i];
+          if ( seen[k] == pass ){
+            continue;
+          }
+          seen[k] = pass;
+          if ( k == r.runnerUp || f.depth == nc/2 ){
+            return false;
+          }
+          f.depth++;
+          if ( !vigilance.passes( module.weight( k ) ) ){
+            f.failures++;
+            continue;
+          }
+          double T = core::activation( net.rule, module, x, module.weight( k ) );
+          if ( std::isnan( T ) ){
+            return false;
+          }
+          if ( f.J == -1 || better( T, k, T_J, f.J ) ){
+            if ( f.J != -1 && ( f.runnerUp == -1 || better( T_J, f.J, f.T_runnerUp, f.runnerUp ) ) ){
+              f.runnerUp = f.J;
+              f.T_runnerUp = T_J;
+            }
+            f.J = k;
+            T_J = T;
+          }
+          else if ( f.runnerUp == -1 || better( T, k, f.T_runnerUp, f.runnerUp ) ){
+            f.runnerUp = k;
+            f.T_runnerUp = T;
+          }
+        }
+        // the unchanged runner-up wins: the next best of the unchanged categories is not known
+        return !( r.runnerUp != -1 && ( f.J == -1 || better( r.T_runnerUp, r.runnerUp, T_J, f.J ) ) );
+      }
+
+      // learn: learn of module 0, with the search verified from the last epoch if possible
+      void ActiveSet::learn( Network &net, long row, const double *x ){
+        Module &module = net.modules[0];
+        ModuleStats *s = net.moduleStats( 0 );
+        PhaseTimer timer( s != NULL );
+        if ( row == (long)rows.size() ){
+          Row r = { -1, -1, 0, 0 };
+          rows.push_back( r );
+        }
+        Row &r = rows[row];
+        // like learn, the first category of an empty module is not learned by the next module
+        bool empty = module.numCategories == 0;
+
+        Search f;
+        if ( r.J == -1 || !verify( net, r, x, f ) ){
+          search( net, x, f );
+        }
+        if ( s ){
+          s->search( f.depth, f.failures );
+          s->searchTime += timer.lap();
+        }
+
+        if ( f.J == -1 ){
+          // no category passes the vigilance test
+          f.J = module.numCategories;
+          newCategory( net, module, x );
+          log.push_back( f.J );
+        }
+        else{
+          module.Jmax[0] = f.J;
+          if ( weightUpdate( net, module, f.J, x, module.beta ) > 0 ){
+            log.push_back( f.J );
+          }
+          module.counter[f.J]++;
+        }
+        if ( s ){
+          s->updateTime += timer.lap();
+        }
+        r.J = f.J;
+        r.runnerUp = f.runnerUp;
+        r.T_runnerUp = f.runnerUp == -1 ? 0 : f.T_runnerUp;
+        r.stamp = clock();
+
+        if ( !empty && net.hasMoreModules( 0 ) ){
+          ART::learn( net, 1, module.weight( f.J ) );
+        }
+      }
+
+      /* Speculation: the speculative search of train. The rows of a window are searched in
+         parallel against the weights at the start of the window, then learned in order. The search
+         of a row holds if the categories modified by the rows before it in the window do not change
+         it: its category is not one of them and none of them passes the vigilance test with a
+         better activation, or at all if it found none. The other rows are searched again, so
+         training is the same as without speculation. With coded, the rows are codes already, as the
+         weights of the module below are for the upper modules (see trainDeferred). */
+      class Speculation {
+      public:
+        Speculation( int window, int threads, bool coded = false ) :
+          window( window ), threads( threads ), coded( coded ), pass( 0 ) {}
+        void learn( Network &net, Rows x );
+
+      private:
+        struct Search {
+          int J;
+          double T_J;
+          int depth;
+          int failures;
+          bool nan;             // an activation is not a number, so the order may not hold
+        };
+
+        bool holds( const Network &net, const double *x, const Search &f ) const;
+        void commit( Network &net, const double *x, const Search &f );
+
+        int window;
+        int threads;
+        bool coded;
+        std::vector< double > codes;
+        std::vector< Search > searches;
+        std::vector< int > modified;    // the categories learned in the window so far
+        std::vector< long > seen;       // seen[k]: the last window that modified category k
+        long pass;
+      };
+
+      // holds: whether the search of x against the weights at the start of the window holds
+      bool Speculation::holds( const Network &net, const double *x, const Search &f ) const {
+        if ( modified.empty() ){
+          return true;
+        }
+        if ( f.nan ){
+          return false;
+        }
+        const Module &module = net.modules[0];
+        for ( int k : modified ){
+          if ( k == f.J ){
+            return false;
+          }
+          if ( match( net.rule, module, x, module.weight( k ) ) >= module.rho ){
+            if ( f.J == -1 ){
+              return false;
+            }
+            double T = core::activation( net.rule, module, x, module.weight( k ) );
+            if ( std::isnan( T ) || better( T, k, f.T_J, f.J ) ){
+              return false;
+            }
+          }
+        }
+        return true;
+      }
+
+      // commit: the rest of learn of module 0 after the search
+      void Speculation::commit( Network &net, const double *x, const Search &f ){
+        Module &module = net.modules[0];
+        if ( ModuleStats *s = net.moduleStats( 0 ) ){
+          s->search( f.depth, f.failures );
+        }
+        int J = f.J;
+        if ( J == -1 ){
+          // like learn, the first category of an empty module is not learned by the next module
+          bool empty = module.numCategories == 0;
+          J = module.numCategories;
+          newCategory( net, module, x );
+          if ( empty ){
+            return;
+          }
+        }
+        else{
+          module.Jmax[0] = J;
+          weightUpdate( net, module, J, x, module.beta );
+          module.counter[J]++;
+        }
+        if ( net.hasMoreModules( 0 ) ){
+          ART::learn( net, 1, module.weight( J ) );
+        }
+      }
+
+      // learn: learn the rows of x in order, a window at a time
+      void Speculation::learn( Network &net, Rows x ){
+        Module &module = net.modules[0];
+        int cd = codeDimension( net.rule, net.dimension );
+        for ( int first = 0; first < x.rows; first += window ){
+          int last = std::min( first + window, x.rows );
+          int nc = module.numCategories;
+          codes.resize( (size_t)( last - first ) * cd );
+          searches.resize( last - first );
+          // the threads only read the blocks
+          module.syncBlocks();
+          parallel( threads, [&]( int t ){
+            std::vector< double > a;
+            std::vector< int > T_j;
+            for ( int i = first + (long)( last - first ) * t / threads; i < first + (long)( last - first ) * ( t + 1 ) / threads; i++ ){
+              double *code = &codes[(size_t)( i - first ) * cd];
+              if ( coded ){
+                std::copy( x.row( i ), x.row( i ) + cd, code );
+              }
+              else{
+                processCode( net.rule, x.row( i ), x.cols, code );
+              }
+              Search &f = searches[i - first];
+              f.J = -1;
+              f.T_J = 0;
+              f.depth = nc;
+              f.failures = nc;
+              f.nan = false;
+              if ( nc == 0 ){
+                continue;
+              }
+              activation( net, module, code, a );
+              for ( double T : a ){
+                f.nan = f.nan || std::isnan( T );
+              }
+              sortIndex( a, T_j );
+              Vigilance vigilance( net.rule, module, code );
+              for ( int j = 0; j < nc; j++ ){
+                if ( vigilance.passes( module.weight( T_j[j] ) ) ){
+                  f.J = T_j[j];
+                  f.T_J = a[f.J];
+                  f.depth = j + 1;
+                  f.failures = j;
+                  break;
+                }
+              }
+            }
+          } );
+
+          pass++;
+          modified.clear();
+          for ( int i = first; i < last; i++ ){
+            const double *code = &codes[(size_t)( i - first ) * cd];
+            if ( holds( net, code, searches[i - first] ) ){
+              commit( net, code, searches[i - first] );
+            }
+            else{
+              ART::learn( net, 0, code );
+            }
+            int J = module.Jmax[0];
+            seen.resize( module.numCategories, -1 );
+            if ( seen[J] != pass ){
+              seen[J] = pass;
+              modified.push_back( J );
+            }
+          }
+        }
+      }
+
+    }
+
+    void train( Network &net, Rows x, bool activeSet ){
+      checkDimension( net, x );
+      MemorySource source( x );
+      train( net, source, activeSet );
+    }
+
+    // epochs: the epoch loop of train. learnEpoch learns every row once and returns the number of
+    // rows; the loop stops at maxEpochs or when the convergence criteria are met. Returns the rows
+    // learned in all the epochs.
+    static long epochs( Network &net, const std::function< long() > &learnEpoch ){
+      EpochProgress progress;
+      ConvergenceTest convergence( net );
+      long rows = 0;
+      int ep = net.maxEpochs;
+      for ( int i = 1; i <= ep; i++ ){
+        rows += learnEpoch();
+
+        int change = totalChange( net );
+        StopReason reason = convergence.epoch( net, i, change );
+        progress.epoch( net, i, rows, change, reason );
+        if ( reason != STOP_NONE && reason != STOP_MAX_EPOCHS ) {
+          net.epochs = i;
+          break;
+        } else{
+          if ( i < ep ){
+            // only reset counters if it hasn't reached the maximum epoch
+            // that way if the user wants to stop the learning using fewer epochs
+            // then the node counters are still available for inspection
+            for ( Module &module : net.modules ){
+              counterReset( module );
+              changeReset( module );
+            }
+          }
+        }
+      }
+      for ( Module &module : net.modules ){
+        module.trim();
+      }
+      return rows;
+    }
+
+    // train: the data is read from the source once per epoch, chunk by chunk. With activeSet, each
+    // row is searched from the category it resonated with in the last epoch (see ActiveSet).
+    void train( Network &net, RowSource &source, bool activeSet ){
+      startStats( net );
+      PhaseTimer timer( net.stats != NULL );
+      std::vector< double > code( codeDimension( net.rule, net.dimension ) );
+      ActiveSet active;
+      long rows = epochs( net, [&]{
+        Chunk chunk;
+        long n = 0, row = 0;
+        active.startEpoch();
+        source.rewind();
+        while ( source.next( chunk ) ){
+          checkDimension( net, chunk.x );
+          for ( int k = 0; k < chunk.x.rows; k++ ){
+            processCode( net.rule, chunk.x.row( k ), chunk.x.cols, code.data() );
+            if ( activeSet ){
+              active.learn( net, row++, code.data() );
+            }
+            else{
+              learn( net, 0, code.data() );
+            }
+          }
+          n += chunk.x.rows;
+        }
+        return n;
+      } );
+      if ( net.stats ){
+        net.stats->add( rows, timer.lap() );
+      }
+    }
+
+    // learnNew: learn x among the categories of module 0 from first on, and return the category it
+    // resonated with
+    static int learnNew( Network &net, const double *x, int first ){
+      Module &module = net.modules[0];
+      int nc = module.numCategories;
+      std::vector< double > a( nc - first );
+      std::vector< int > T_j;
+      for ( int k = first; k < nc; k++ ){
+        a[k - first] = core::activation( net.rule, module, x, module.weight( k ) );
+      }
+      sortIndex( a, T_j );
+      Vigilance vigilance( net.rule, module, x );
+      for ( int j : T_j ){
+        int J = first + j;
+        if ( vigilance.passes( module.weight( J ) ) ){
+          weightUpdate( net, module, J, x, module.beta );
+          module.counter[J]++;
+          return J;
+        }
+      }
+      newCategory( net, module, x );
+      return nc;
+    }
+
+    // learnBatch: learn the rows first, ..., last - 1 of the coded rows as a batch (see trainBatch)
+    static void learnBatch( Network &net, const std::vector< double > &codes, int cd, int first, int last, int n,
+                            std::vector< int > &category ){
+      Module &module = net.modules[0];
+      int nc = module.numCategories;
+      // the threads only read the blocks, then update those of their categories
+      module.syncBlocks();
+      parallel( n, [&]( int t ){
+        std::vector< double > a;
+        std::vector< int > T_j;
+        for ( int i = first + (long)( last - first ) * t / n; i < first + (long)( last - first ) * ( t + 1 ) / n; i++ ){
+          const double *code = &codes[(size_t)i * cd];
+          category[i] = -1;
+          if ( nc == 0 ){
+            continue;
+          }
+          activation( net, module, code, a );
+          sortIndex( a, T_j );
+          Vigilance vigilance( net.rule, module, code );
+          for ( int j = 0; j < nc && category[i] == -1; j++ ){
+            if ( vigilance.passes( module.weight( T_j[j] ) ) ){
+              category[i] = T_j[j];
+            }
+          }
+        }
+      } );
+
+      // the rows of each category, in order
+      std::vector< int > start( nc + 1, 0 );
+      for ( int i = first; i < last; i++ ){
+        if ( category[i] != -1 ){
+          start[category[i] + 1]++;
+        }
+      }
+      for ( int k = 0; k < nc; k++ ){
+        start[k + 1] += start[k];
+      }
+      std::vector< int > order( start[nc] );
+      std::vector< int > next( start.begin(), start.end() - 1 );
+      for ( int i = first; i < last; i++ ){
+        if ( category[i] != -1 ){
+          order[next[category[i]]++] = i;
+        }
+      }
+
+      // the counters of the threads, added to those of the module afterwards
+      std::vector< double > delta( n, 0 );
+      std::vector< int > changes( n, 0 ), changed( n, 0 );
+      parallel( n, [&]( int t ){
+        for ( int k = t; k < nc; k += n ){
+          for ( int r = start[k]; r < start[k + 1]; r++ ){
+            const double *code = &codes[(size_t)order[r] * cd];
+            if ( !( match( net.rule, module, code, module.weight( k ) ) >= module.rho ) ){
+              // the rows learned before it moved the category out of its reach
+              category[order[r]] = -2;
+              continue;
+            }
+            double s = core::weightUpdate( net.rule, module, module.beta, code, module.weight( k ) );
+            // the envelopes are shared by the categories of other threads, so they are marked below
+            if ( k < module.blocks.size ){
+              module.blocks.set( k, module.weight( k ) );
+            }
+            delta[t] += s;
+            if ( s > 0.0000001 ){
+              if ( module.change[k]++ == 0 ){
+                changed[t]++;
+              }
+              changes[t]++;
+            }
+            module.counter[k]++;
+          }
+        }
+      } );
+      for ( int t = 0; t < n; t++ ){
+        module.weightDelta += delta[t];
+        module.changes += changes[t];
+        module.changed += changed[t];
+      }
+      for ( int k = 0; k < nc; k++ ){
+        if ( start[k + 1] > start[k] ){
+          module.envelopes.touch( k );
+        }
+      }
+
+      // the rows left over, in order: those no category matched search the categories created by
+      // the batch, and those their category no longer matches search all of them
+      for ( int i = first; i < last; i++ ){
+        if ( category[i] < 0 ){
+          category[i] = learnNew( net, &codes[(size_t)i * cd], category[i] == -1 ? nc : 0 );
+        }
+      }
+      module.Jmax[0] = category[last - 1];
+      if ( net.hasMoreModules( 0 ) ){
+        for ( int i = first; i < last; i++ ){
+          learn( net, 1, module.weight( category[i] ) );
+        }
+      }
+    }
+
+    // trainBatch: batch epochs, in the manner of k-means. The rows of each batch of batchSize rows
+    // (all the rows if 0) are assigned in parallel to the categories of module 0 they resonate with
+    // among the weights left by the previous batch. Each category then learns its rows in order on
+    // one thread (for fast fuzzy learning, the minimum of the rows), skipping those it no longer
+    // matches, and the rows left over are learned serially in order. The upper modules learn the
+    // categories of the rows in order. The result differs from train but not with the number of
+    // threads.
+    void trainBatch( Network &net, Rows x, int batchSize, int threads ){
+      if ( batchSize < 0 ){
+        throw std::invalid_argument( "The batch size must not be negative." );
+      }
+      checkDimension( net, x );
+      startStats( net );
+      PhaseTimer timer( net.stats != NULL );
+      int n = numThreads( threads );
+      int cd = codeDimension( net.rule, net.dimension );
+      std::vector< double > codes( (size_t)x.rows * cd );
+      parallel( n, [&]( int t ){
+        for ( int i = (long)x.rows * t / n; i < (long)x.rows * ( t + 1 ) / n; i++ ){
+          processCode( net.rule, x.row( i ), x.cols, &codes[(size_t)i * cd] );
+        }
+      } );
+
+      int size = batchSize > 0 ? batchSize : std::max( x.rows, 1 );
+      std::vector< int > category( x.rows );
+      long rows = epochs( net, [&]{
+        for ( int first = 0; first < x.rows; first += size ){
+          learnBatch( net, codes, cd, first, std::min( first + size, x.rows ), n, category );
+        }
+        return (long)x.rows;
+      } );
+      if ( net.stats ){
+        net.stats->add( rows, timer.lap() );
+      }
+    }
+
+    // mergeCategory: learn the category v of another module into module 0 like learn, but with
+    // the vigilance test and the update on the merged category (see categoryMatch, categoryWeight
+    // and categoryUpdate). The category counts the rows of v.
+    static void mergeCategory( Network &net, const double *v, int rows ){
+      Module &module = net.modules[0];
+      int nc = module.numCategories;
+      int J = -1;
+      if ( nc > 0 ){
+        std::vector< double > a;
+        std::vector< int > T_j;
+        activation( net, module, v, a );
+        sortIndex( a, T_j );
+        for ( int j = 0; j < nc && J == -1; j++ ){
+          if ( categoryMatch( net.rule, module, v, module.weight( T_j[j] ) ) >= module.rho ){
+            J = T_j[j];
+          }
+        }
+      }
+      if ( J == -1 ){
+        newCategory( net, module, v );
+        J = nc;
+        categoryWeight( net.rule, module, v, module.weight( J ) );
+        module.counter[J]--;
+      }
+      else{
+        module.Jmax[0] = J;
+        double s = categoryUpdate( net.rule, module, module.beta, v, module.weight( J ) );
+        module.updateBlock( J );
+        module.weightDelta += s;
+        if ( s > 0.0000001 ){
+          countChange( module, J );
+        }
+      }
+      module.counter[J] += rows;
+      if ( net.hasMoreModules( 0 ) ){
+        learn( net, 1, module.weight( J ) );
+      }
+    }
+
+    // trainSharded: train copies of the network on contiguous shards of the rows, threads at a
+    // time, then merge them: the network starts as the first shard, and the module 0 categories of
+    // the other shards, in shard order, are learned as its rows under the same vigilance (see
+    // mergeCategory). With one shard the result is train's. The result depends on the number of
+    // shards but not on the threads. It approximates train, so with compare a copy of the network
+    // is also trained serially and the categories the two give the rows are compared. The stats of
+    // the network cover the merge.
+    ShardReport trainSharded( Network &net, Rows x, int shards, int threads, bool compare ){
+      if ( shards < 1 ){
+        throw std::invalid_argument( "The number of shards must be at least 1." );
+      }
+      checkDimension( net, x );
+      shards = std::max( 1, std::min( shards, x.rows ) );
+
+      ShardReport report = ShardReport();
+      report.shards = shards;
+
+      Network serial;
+      if ( compare ){
+        serial = net;
+        serial.stats = NULL;
+        serial.progress = NULL;
+      }
+
+      std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+      std::vector< Network > shard( shards, net );
+      for ( Network &s : shard ){
+        s.stats = NULL;
+        s.progress = NULL;
+      }
+      int n = std::min( numThreads( threads ), shards );
+      parallel( n, [&]( int t ){
+        for ( int i = t; i < shards; i += n ){
+          int first = (int)( (long)x.rows * i / shards );
+          int last = (int)( (long)x.rows * ( i + 1 ) / shards );
+          train( shard[i], Rows( x.row( first ), last - first, x.cols ) );
+        }
+      } );
+      std::chrono::steady_clock::time_point merged = std::chrono::steady_clock::now();
+      report.shardTime = std::chrono::duration< double >( merged - start ).count();
+
+      for ( const Network &s : shard ){
+        report.shardCategories += s.modules[0].numCategories;
+      }
+      // the network starts as the first shard, which the others are merged into
+      Stats *stats = net.stats;
+      ProgressSink *progress = net.progress;
+      net = shard[0];
+      net.stats = stats;
+      net.progress = progress;
+      startStats( net );
+      PhaseTimer timer( net.stats != NULL );
+      long rows = epochs( net, [&]{
+        const Network &first = shard[0];
+        for ( int id = 0; id < net.numModules(); id++ ){
+          for ( int k = 0; k < first.modules[id].numCategories; k++ ){
+            net.modules[id].counter[k] += first.modules[id].counter[k];
+          }
+        }
+        for ( int i = 1; i < shards; i++ ){
+          const Module &m = shard[i].modules[0];
+          for ( int k = 0; k < m.numCategories; k++ ){
+            mergeCategory( net, categoryInput( net.rule, m, m.weight( k ) ), m.counter[k] );
+          }
+        }
+        return (long)report.shardCategories;
+      } );
+      if ( net.stats ){
+        net.stats->add( rows, timer.lap() );
+      }
+      report.mergeTime = std::chrono::duration< double >( std::chrono::steady_clock::now() - merged ).count();
+      report.categories = net.modules[0].numCategories;
+
+      if ( compare ){
+        start = std::chrono::steady_clock::now();
+        train( serial, x );
+        report.serialTime = std::chrono::duration< double >( std::chrono::steady_clock::now() - start ).count();
+        report.compared = true;
+        report.serialCategories = serial.modules[0].numCategories;
+        report.agreement = adjustedRandIndex( predict( net, 0, x ), predict( serial, 0, x ) );
+      }
+      return report;
+    }
+
+    void trainSpeculative( Network &net, Rows x, int window, int threads ){
+      checkDimension( net, x );
+      MemorySource source( x );
+      trainSpeculative( net, source, window, threads );
+    }
+
+    // trainSpeculative: train with the rows of each window of window rows (128 per thread if 0)
+    // searched in parallel (see Speculation). The result is the same as train.
+    void trainSpeculative( Network &net, RowSource &source, int window, int threads ){
+      if ( window < 0 ){
+        throw std::invalid_argument( "The window must not be negative." );
+      }
+      startStats( net );
+      PhaseTimer timer( net.stats != NULL );
+      int n = numThreads( threads );
+      Speculation speculation( window > 0 ? window : 128 * n, n );
+      long rows = epochs( net, [&]{
+        Chunk chunk;
+        long m = 0;
+        source.rewind();
+        while ( source.next( chunk ) ){
+          checkDimension( net, chunk.x );
+          speculation.learn( net, chunk.x );
+          m += chunk.x.rows;
+        }
+        return m;
+      } );
+      if ( net.stats ){
+        net.stats->add( rows, timer.lap() );
+      }
+    }
+
+    void trainDeferred( Network &net, Rows x, int threads ){
+      checkDimension( net, x );
+      MemorySource source( x );
+      trainDeferred( net, source, threads );
+    }
+
+    // trainDeferred: train module 0 alone on the rows like train, then each upper module in turn on
+    // the settled categories of the module below it: its rows are their weights in category order,
+    // the inputs learn would pass up for them, learned for up to maxEpochs epochs with the
+    // speculative search on more than one thread. The upper modules are not learned once per row,
+    // so their counters count the categories below them and the result differs from train with
+    // more than one module. The epochs, the stats and the progress are those of module 0.
+    void trainDeferred( Network &net, RowSource &source, int threads ){
+      startStats( net );
+      PhaseTimer timer( net.stats != NULL );
+      int n = numThreads( threads );
+      int cd = codeDimension( net.rule, net.dimension );
+      std::vector< double > code( cd );
+      long rows = 0;
+      for ( int id = 0; id < net.numModules(); id++ ){
+        std::vector< double > codes;
+        int nc = 0;
+        if ( id > 0 ){
+          const Module &lower = net.modules[id - 1];
+          nc = lower.numCategories;
+          codes.resize( (size_t)nc * cd );
+          for ( int k = 0; k < nc; k++ ){
+            std::copy( lower.weight( k ), lower.weight( k ) + cd, &codes[(size_t)k * cd] );
+          }
+        }
+        MemorySource categories( Rows( codes.data(), nc, cd ) );
+        RowSource &input = id == 0 ? source : categories;
+
+        // the module is trained as a network of its own, so learn does not move up from it
+        Network level;
+        level.rule = net.rule;
+        level.dimension = net.dimension;
+        level.epochs = net.epochs;
+        level.maxEpochs = net.maxEpochs;
+        level.initialized = net.initialized;
+        level.convergence = net.convergence;
+        if ( id == 0 ){
+          level.stats = net.stats;
+          level.progress = net.progress;
+        }
+        level.modules.push_back( std::move( net.modules[id] ) );
+        Speculation speculation( 128 * n, n, true );
+        long learned = epochs( level, [&]{
+          Chunk chunk;
+          long m = 0;
+          input.rewind();
+          while ( input.next( chunk ) ){
+            if ( id == 0 ){
+              checkDimension( level, chunk.x );
+              for ( int k = 0; k < chunk.x.rows; k++ ){
+                processCode( net.rule, chunk.x.row( k ), chunk.x.cols, code.data() );
+                learn( level, 0, code.data() );
+              }
+            }
+            else if ( n > 1 ){
+              speculation.learn( level, chunk.x );
+            }
+            else{
+              for ( int k = 0; k < chunk.x.rows; k++ ){
+                learn( level, 0, chunk.x.row( k ) );
+              }
+            }
+            m += chunk.x.rows;
+          }
+          return m;
+        } );
+        net.modules[id] = std::move( level.modules[0] );
+        if ( id == 0 ){
+          rows = learned;
+          net.epochs = level.epochs;
+          net.stopReason = level.stopReason;
+        }
+      }
+      if ( net.stats ){
+        net.stats->add( rows, timer.lap() );
+      }
+    }
+
+    // partialTrain: learn each row of x once against the current state of the network, as the
+    // next part of a data stream. There is no epoch bookkeeping and the weight storage is not
+    // trimmed afterwards, so the next call does not need to grow it again.
+    PartialTrainResult partialTrain( Network &net, Rows x ){
+      checkDimension( net, x );
+      startStats( net );
+
+      PartialTrainResult result;
+      result.category.resize( x.rows );
+      result.newCategory.resize( x.rows );
+      result.time.resize( x.rows );
+
+      // the changes reported are those made by this part of the stream
+      for ( Module &module : net.modules ){
+        changeReset( module );
+      }
+
+      Module &module = net.modules[0];
+      std::vector< double > code( codeDimension( net.rule, net.dimension ) );
+      for ( int k = 0; k < x.rows; k++ ){
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        int nc = module.numCategories;
+        processCode( net.rule, x.row( k ), x.cols, code.data() );
+        learn( net, 0, code.data() );
+        std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+
+        result.category[k] = module.Jmax[0];
+        result.newCategory[k] = module.numCategories > nc;
+        result.time[k] = std::chrono::duration< double, std::micro >( end - start ).count();
+      }
+
+      return result;
+    }
+
+    // predict: the category of module id for each row of x, or -1 if there is none
+    std::vector< int > predict( Network &net, int id, Rows x ){
+      if ( id < 0 || id >= net.numModules() ){
+        throw std::invalid_argument( "The module id is out of range." );
+      }
+      checkDimension( net, x );
+      startStats( net );
+      PhaseTimer timer( net.stats != NULL );
+
+      std::vector< int > category( x.rows );
+      std::vector< double > code( codeDimension( net.rule, net.dimension ) );
+      for ( int i = 0; i < x.rows; i++ ){
+        processCode( net.rule, x.row( i ), x.cols, code.data() );
+        category[i] = classify( net, id, code.data() );
+      }
+      if ( net.stats ){
+        net.stats->add( x.rows, timer.lap() );
+      }
+      return category;
+    }
+
+    namespace {
+
+      // children: the categories of module id - 1 under each category of module id, in ascending
+      // order from child[start[k]] to child[start[k + 1]]. A category is under the category of
+      // module id its weight resonates with, as learn passed it up, or under the one with the
+      // highest activation if none does now.
+      void children( Network &net, int id, std::vector< int > &start, std::vector< int > &child ){
+        const Module &lower = net.modules[id - 1];
+        int nc = net.modules[id].numCategories;
+        std::vector< int > parent( lower.numCategories, -1 );
+        std::vector< double > a;
+        for ( int k = 0; k < lower.numCategories && nc > 0; k++ ){
+          parent[k] = classify( net, id, lower.weight( k ) );
+          if ( parent[k] == -1 ){
+            activation( net, net.modules[id], lower.weight( k ), a );
+            parent[k] = 0;
+            for ( int j = 1; j < nc; j++ ){
+              if ( a[j] > a[parent[k]] ){
+                parent[k] = j;
+              }
+            }
+          }
+        }
+        start.assign( nc + 1, 0 );
+        for ( int p : parent ){
+          if ( p != -1 ){
+            start[p + 1]++;
+          }
+        }
+        for ( int j = 0; j < nc; j++ ){
+          start[j + 1] += start[j];
+        }
+        child.resize( start[nc] );
+        std::vector< int > next( start.begin(), start.end() - 1 );
+        for ( int k = 0; k < lower.numCategories; k++ ){
+          if ( parent[k] != -1 ){
+            child[next[parent[k]]++] = k;
+          }
+        }
+      }
+
+      // classifyAmong: classify with the candidates of module id only, in ascending order, which
+      // picks the category classify would among them. best gets the first width candidates in
+      // the order of their activations.
+      int classifyAmong( Network &net, int id, const double *x, const std::vector< int > &candidates, int width,
+                         std::vector< int > &best ){
+        const Module &module = net.modules[id];
+        ModuleStats *s = net.moduleStats( id );
+        PhaseTimer timer( s != NULL );
+        const Kernels &f = kernels( net.rule, module.weightDimension );
+        int n = candidates.size();
+        std::vector< double > a( n );
+        std::vector< int > T_j;
+        for ( int j = 0; j < n; j++ ){
+          a[j] = f.activation( module, x, module.weight( candidates[j] ) );
+        }
+        sortIndex( a, T_j );
+        if ( s ){
+          s->activationTime += timer.lap();
+        }
+        best.clear();
+        for ( int j = 0; j < std::min( width, n ); j++ ){
+          best.push_back( candidates[T_j[j]] );
+        }
+        Vigilance vigilance( net.rule, module, x );
+        int category = -1;
+        int j = 0;
+        for ( ; j < n; j++ ){
+          if ( vigilance.passes( module.weight( candidates[T_j[j]] ) ) ){
+            category = candidates[T_j[j]];
+            break;
+          }
+        }
+        net.modules[id].Jmax[0] = category;
+        if ( s ){
+          s->search( category == -1 ? n : j + 1, j );
+          s->searchTime += timer.lap();
+        }
+        return category;
+      }
+    }
+
+    // predictHierarchy: classify each row with the top module, then each module below only with
+    // the categories under (see children) the width categories of the module above with the
+    // highest activations, so the upper modules index the categories of module 0. Module 0 is
+    // searched in full if none of its candidates resonates; a module above it is left at -1.
+    HierarchyPrediction predictHierarchy( Network &net, Rows x, int width ){
+      if ( width < 1 ){
+        throw std::invalid_argument( "The width must be at least 1." );
+      }
+      checkDimension( net, x );
+      startStats( net );
+      PhaseTimer timer( net.stats != NULL );
+      int top = net.numModules() - 1;
+
+      // the index is not part of the counters
+      Stats *stats = net.stats;
+      net.stats = NULL;
+      std::vector< std::vector< int > > start( top + 1 ), child( top + 1 );
+      for ( int id = 1; id <= top; id++ ){
+        children( net, id, start[id], child[id] );
+      }
+      net.stats = stats;
+
+      HierarchyPrediction p;
+      p.modules = top + 1;
+      p.path.assign( (size_t)x.rows * p.modules, -1 );
+      p.fallback.assign( x.rows, 0 );
+      std::vector< double > code( codeDimension( net.rule, net.dimension ) );
+      std::vector< int > candidates, best;
+      for ( int i = 0; i < x.rows; i++ ){
+        processCode( net.rule, x.row( i ), x.cols, code.data() );
+        int *path = &p.path[(size_t)i * p.modules];
+        best.clear();
+        for ( int id = top; id >= 0; id-- ){
+          int nc = net.modules[id].numCategories;
+          candidates.clear();
+          if ( id < top ){
+            for ( int J : best ){
+              candidates.insert( candidates.end(), child[id + 1].begin() + start[id + 1][J],
+                                 child[id + 1].begin() + start[id + 1][J + 1] );
+            }
+            std::sort( candidates.begin(), candidates.end() );
+            path[id] = classifyAmong( net, id, code.data(), candidates, width, best );
+          }
+          // the top module, or no candidate of module 0 resonates
+          if ( ( id == top || ( id == 0 && path[id] == -1 ) ) && (int)candidates.size() < nc ){
+            p.fallback[i] = id < top;
+            candidates.resize( nc );
+            for ( int k = 0; k < nc; k++ ){
+              candidates[k] = k;
+            }
+            path[id] = classifyAmong( net, id, code.data(), candidates, width, best );
+          }
+        }
+      }
+      if ( net.stats ){
+        net.stats->add( x.rows, timer.lap() );
+      }
+      return p;
+    }
+  }
+
+}
@@ -0,0 +1,560 @@
+/****************************************************************************
+ *
+ *  core-artmap.cpp
+ *  ARTMAP on native network state
+ *
+ ****************************************************************************/
+
+#include <chrono>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include "core.h"
+
+namespace core {
+
+  namespace ARTMAP {
+
+    Network create( Rule rule, int dimension, double vigilance, double learningRate, int categorySize, int maxEpochs, bool simplified ){
+      if ( rule == RULE_HYPERSPHERE && !simplified ){
+        throw std::invalid_argument( "The hypersphere model can only be used in the simplified ARTMAP." );
+      }
+      Network net = ART::create( rule, dimension, simplified ? 1 : 2, vigilance, learningRate, categorySize, maxEpochs );
+      net.type = NETWORK_ARTMAP;
+      net.simplified = simplified;
+      net.mapfield.rho = vigilance;
+      net.mapfield.beta = learningRate;
+      return net;
+    }
+
+    // The map field grows as the categories are created, so only the modules are initialized.
+    void init( Network &net ){
+      ART::init( net );
+    }
+
+    namespace simplified {
+
+      void newCategory( Mapfield &mapfield, int label ){
+        int newCategoryIndex = mapfield.numCategories;
+        if ( newCategoryIndex == (int)mapfield.label.size() ){
+          // reached the max capacity, so add more rows
+          mapfield.label.resize( newCategoryIndex + mapfield.capacity, 0 );
+          mapfield.change.resize( newCategoryIndex + mapfield.capacity, 0 );
+        }
+        mapfield.label[newCategoryIndex] = label;
+        mapfield.change[newCategoryIndex]++;
+        mapfield.changes++;
+        mapfield.numCategories = newCategoryIndex + 1;
+      }
+
+      void learn( Network &net, const double *d, int label ){
+        Module &module = net.modules[0];
+        Mapfield &mapfield = net.mapfield;
+        ModuleStats *s = net.moduleStats( 0 );
+        PhaseTimer timer( s != NULL );
+
+        int nc = module.numCategories;
+        if ( nc == 0 ){
+          ART::newCategory( net, module, d );
+          newCategory( mapfield, label );
+          if ( s ){
+            s->search( 0, 0 );
+            s->updateTime += timer.lap();
+          }
+          return;
+        }
+
+        std::vector< double > a;
+        std::vector< int > T_j;
+        ART::activation( net, module, d, a );
+        sortIndex( a, T_j );
+        if ( s ){
+          s->activationTime += timer.lap();
+        }
+        double rho = module.rho;
+        int failures = 0;
+        Vigilance vigilance( net.rule, module, d );
+        for ( int j = 0; j < nc; j++ ){
+          int J_max = T_j[j];
+          double m = vigilance.match( module.weight( J_max ), rho );
+          if ( m >= rho ){
+            if ( mapfield.label[J_max] == label ){
+              if ( s ){
+                s->search( j + 1, failures );
+                s->searchTime += timer.lap();
+              }
+              module.Jmax[0] = J_max;
+              ART::weightUpdate( net, module, J_max, d, module.beta );
+              module.counter[J_max]++;
+              if ( s ){
+                s->updateTime += timer.lap();
+              }
+              return;
+            }
+            // match tracking: raise the vigilance just above the match of the wrong category
+            rho = std::min( m + module.epsilon, 1.0 );
+            if ( s ){
+              s->matchTrackingResets++;
+            }
+          }
+          else{
+            failures++;
+          }
+        }
+
+        if ( s ){
+          s->search( nc, failures );
+          s->searchTime += timer.lap();
+        }
+        ART::newCategory( net, module, d );
+        newCategory( mapfield, label );
+        if ( s ){
+          s->updateTime += timer.lap();
+        }
+      }
+
+      // classify: the module a category of the input (-1 if none) and its label
+      int classify( Network &net, const double *d, int &predicted ){
+        const Module &module = net.modules[0];
+        const Mapfield &mapfield = net.mapfield;
+        ModuleStats *s = net.moduleStats( 0 );
+        PhaseTimer timer( s != NULL );
+
+        std::vector< double > a;
+        std::vector< int > T_j;
+        ART::activation( net, module, d, a );
+        sortIndex( a, T_j );
+        if ( s ){
+          s->activationTime += timer.lap();
+        }
+        int nc = module.numCategories;
+        Vigilance vigilance( net.rule, module, d );
+        for ( int j = 0; j < nc; j++ ){
+          int J_max = T_j[j];
+          if ( vigilance.passes( module.weight( J_max ) ) ){
+            predicted = mapfield.label[J_max];
+            if ( s ){
+              s->search( j + 1, j );
+              s->searchTime += timer.lap();
+            }
+            return J_max;
+          }
+        }
+        // can't find a match
+        net.modules[0].Jmax[0] = -1;
+        if ( s ){
+          s->search( nc, nc );
+          s->searchTime += timer.lap();
+        }
+        return -1;
+      }
+    }
+
+    namespace standard {
+
+      // newCategory_a: add a row for the new module a category, linked to all module b categories
+      void newCategory_a( Mapfield &mapfield ){
+        int newCategoryIndex = mapfield.numCategories_a;
+        if ( newCategoryIndex == mapfield.rows ){
+          // reached the max capacity, so add more rows
+          mapfield.rows += mapfield.capacity;
+          mapfield.w.resize( (size_t)mapfield.rows * mapfield.cols, 0 );
+          mapfield.change.resize( mapfield.rows, 0 );
+        }
+        double *w = mapfield.weight( newCategoryIndex );
+        for ( int b = 0; b < mapfield.cols; b++ ){
+          w[b] = 1.0;
+        }
+        mapfield.change[newCategoryIndex]++;
+        mapfield.changes++;
+        mapfield.numCategories_a = newCategoryIndex + 1;
+      }
+
+      // newCategory_b: add a column for the new module b category
+      void newCategory_b( Mapfield &mapfield ){
+        int newCategoryIndex = mapfield.numCategories_b;
+        if ( newCategoryIndex == mapfield.cols ){
+          // reached the max capacity, so add more columns
+          int cols = mapfield.cols + mapfield.capacity;
+          std::vector< double > w( (size_t)mapfield.rows * cols, 0 );
+          for ( int a = 0; a < mapfield.rows; a++ ){
+            for ( int b = 0; b < mapfield.cols; b++ ){
+              w[(size_t)a * cols + b] = mapfield.w[(size_t)a * mapfield.cols + b];
+            }
+          }
+          mapfield.w.swap( w );
+          mapfield.cols = cols;
+        }
+        mapfield.weightDimension = newCategoryIndex + 1;
+        mapfield.numCategories_b = newCategoryIndex + 1;
+      }
+
+      // match: the fuzzy match between the module b category b and the map field row of the
+      // module a category a
+      double match( const Mapfield &mapfield, int a, int b ){
+        double w = mapfield.weight( a )[b];
+        return std::isnan( w ) ? 0 : std::min( 1.0, w );
+      }
+
+      void mapfieldUpdate( Mapfield &mapfield, int a, int b ){
+        double *w = mapfield.weight( a );
+        double s = 0;
+        for ( int k = 0; k < mapfield.cols; k++ ){
+          double y = k == b ? 1.0 : 0.0;
+          double w_new = mapfield.beta * std::min( y, w[k] ) + ( 1.0 - mapfield.beta ) * w[k];
+          s += std::fabs( w[k] - w_new );
+          w[k] = w_new;
+        }
+        if ( s > 0.0000001 ){
+          mapfield.change[a]++;
+          mapfield.changes++;
+        }
+      }
+
+      void learn( Network &net, const double *d, const double *label ){
+        Module &module_a = net.modules[0];
+        Module &module_b = net.modules[1];
+        Mapfield &mapfield = net.mapfield;
+
+        if ( module_a.numCategories == 0 && module_b.numCategories == 0 &&
+             mapfield.numCategories_a == 0 && mapfield.numCategories_b == 0 ){
+          ART::newCategory( net, module_a, d );
+          ART::newCategory( net, module_b, label );
+          // Add new category in b first before a
+          newCategory_b( mapfield );
+          newCategory_a( mapfield );
+          mapfieldUpdate( mapfield, 0, 0 );
+          return;
+        }
+        ModuleStats *s = net.moduleStats( 0 );
+
+        ART::learn( net, module_b.id, label );
+        // add a new ab category whenever a new category is added in F2b
+        if ( module_b.numCategories > mapfield.numCategories_b ){
+          newCategory_b( mapfield );
+        }
+        int Jmax_b = module_b.Jmax[0];
+        PhaseTimer timer( s != NULL );
+
+        // get ART a F2 activations
+        std::vector< double > a;
+        std::vector< int > T_j;
+        ART::activation( net, module_a, d, a );
+        sortIndex( a, T_j );
+        if ( s ){
+          s->activationTime += timer.lap();
+        }
+        int nc_a = module_a.numCategories;
+        double rho_a = module_a.rho;
+        int failures = 0;
+        Vigilance vigilance( net.rule, module_a, d );
+        for ( int j = 0; j < nc_a; j++ ){
+          int Jmax_a = T_j[j];
+          double m = vigilance.match( module_a.weight( Jmax_a ), rho_a );
+          if ( m >= rho_a ){
+            // check the mapfield
+            if ( match( mapfield, Jmax_a, Jmax_b ) >= mapfield.rho ){
+              if ( s ){
+                s->search( j + 1, failures );
+                s->searchTime += timer.lap();
+              }
+              module_a.Jmax[0] = Jmax_a;
+              ART::weightUpdate( net, module_a, Jmax_a, d, module_a.beta );
+              module_a.counter[Jmax_a]++;
+              mapfieldUpdate( mapfield, Jmax_a, Jmax_b );
+              if ( s ){
+                s->updateTime += timer.lap();
+              }
+              return;
+            }
+            rho_a = std::min( m + module_a.epsilon, 1.0 );
+            if ( s ){
+              s->matchTrackingResets++;
+            }
+          }
+          else{
+            failures++;
+          }
+        }
+
+        // if run out of categories, then add a new one in ART a and in ART ab
+        if ( s ){
+          s->search( nc_a, failures );
+          s->searchTime += timer.lap();
+        }
+        ART::newCategory( net, module_a, d );
+        newCategory_a( mapfield );
+        mapfieldUpdate( mapfield, nc_a, Jmax_b );
+        if ( s ){
+          s->updateTime += timer.lap();
+        }
+      }
+
+      // classify: the module a category of the input (-1 if none) and the F1b pattern recalled
+      // through the map field, all NaN if there is none
+      int classify( Network &net, const double *d, std::vector< double > &F1_b ){
+        const Module &module_a = net.modules[0];
+        const Module &module_b = net.modules[1];
+        const Mapfield &mapfield = net.mapfield;
+        ModuleStats *s = net.moduleStats( 0 );
+        PhaseTimer timer( s != NULL );
+
+        F1_b.assign( module_b.weightDimension, std::numeric_limits< double >::quiet_NaN() );
+
+        std::vector< double > a;
+        std::vector< int > T_j;
+        ART::activation( net, module_a, d, a );
+        sortIndex( a, T_j );
+        if ( s ){
+          s->activationTime += timer.lap();
+        }
+        int nc_a = module_a.numCategories;
+        Vigilance vigilance( net.rule, module_a, d );
+        for ( int j = 0; j < nc_a; j++ ){
+          int Jmax_a = T_j[j];
+          if ( vigilance.passes( module_a.weight( Jmax_a ) ) ){
+            if ( s ){
+              s->search( j + 1, j );
+              s->searchTime += timer.lap();
+            }
+            net.modules[0].Jmax[0] = Jmax_a;
+            // recall: reactivate the F2b node that the map field links to retrieve its F1b pattern
+            const double *w = mapfield.weight( Jmax_a );
+            for ( int b = 0; b < mapfield.numCategories_b; b++ ){
+              if ( w[b] == 1 ){
+                const double *f = module_b.weight( b );
+                F1_b.assign( f, f + module_b.weightDimension );
+                break;
+              }
+            }
+            return Jmax_a;
+          }
+        }
+        net.modules[0].Jmax[0] = -1;
+        if ( s ){
+          s->search( nc_a, nc_a );
+          s->searchTime += timer.lap();
+        }
+        return -1;
+      }
+
+      // test: whether the map field links the last classified module a category to the module b
+      // category of the label. Returns -1 if either category is unknown.
+      int test( Network &net, const double *label ){
+        int category_b = ART::classify( net, net.modules[1].id, label );
+        int Jmax_a = net.modules[0].Jmax[0];
+        if ( category_b == -1 || Jmax_a == -1 ){
+          return -1;
+        }
+        return match( net.mapfield, Jmax_a, category_b ) >= net.mapfield.rho ? 1 : 0;
+      }
+
+      void trim( Mapfield &mapfield ){
+        int cols = mapfield.numCategories_b;
+        std::vector< double > w( (size_t)mapfield.numCategories_a * cols );
+        for ( int a = 0; a < mapfield.numCategories_a; a++ ){
+          for ( int b = 0; b < cols; b++ ){
+            w[(size_t)a * cols + b] = mapfield.weight( a )[b];
+          }
+        }
+        mapfield.w.swap( w );
+        mapfield.rows = mapfield.numCategories_a;
+        mapfield.cols = cols;
+        mapfield.change.resize( mapfield.numCategories_a );
+      }
+    }
+
+    void checkNetwork( const Network &net ){
+      if ( net.type != NETWORK_ARTMAP ){
+        throw std::invalid_argument( "The network is not an ARTMAP." );
+      }
+      if ( net.rule == RULE_HYPERSPHERE && !net.simplified ){
+        throw std::invalid_argument( "The hypersphere model can only be used in the simplified ARTMAP." );
+      }
+    }
+
+    void checkTarget( const Network &net, Rows x, Rows target ){
+      checkNetwork( net );
+      if ( x.cols != net.dimension ){
+        throw std::invalid_argument( "The number of columns in the data must be the dimension of the network." );
+      }
+      if ( target.rows != x.rows ){
+        throw std::invalid_argument( "The number of labels must be the number of rows in the data." );
+      }
+      if ( net.simplified ? target.cols != 1 : target.cols != net.dimension ){
+        throw std::invalid_argument( net.simplified ? "The simplified ARTMAP requires a vector for the target." :
+                                                      "The number of columns in the target must be the dimension of the network." );
+      }
+    }
+
+    void learnRow( Network &net, Rows x, Rows target, int j, std::vector< double > &code, std::vector< double > &label ){
+      processCode( net.rule, x.row( j ), x.cols, code.data() );
+      if ( net.simplified ){
+        simplified::learn( net, code.data(), target.row( j )[0] );
+      }
+      else{
+        processCode( net.rule, target.row( j ), target.cols, label.data() );
+        standard::learn( net, code.data(), label.data() );
+      }
+    }
+
+    void train( Network &net, Rows x, Rows target ){
+      checkTarget( net, x, target );
+      MemorySource source( x, target );
+      train( net, source );
+    }
+
+    // train: the data and the target are read from the source once per epoch, chunk by chunk
+    void train( Network &net, RowSource &source ){
+      checkNetwork( net );
+      startStats( net );
+      PhaseTimer timer( net.stats != NULL );
+      EpochProgress progress;
+      ConvergenceTest convergence( net );
+      long rows = 0;
+
+      int ep = net.maxEpochs;
+      int targetCols = net.simplified ? 1 : net.dimension;
+      std::vector< double > code( codeDimension( net.rule, net.dimension ) );
+      std::vector< double > label( codeDimension( net.rule, targetCols ) );
+      for ( int i = 1; i <= ep; i++ ){
+        Chunk chunk;
+        source.rewind();
+        while ( source.next( chunk ) ){
+          checkTarget( net, chunk.x, chunk.target );
+          for ( int j = 0; j < chunk.x.rows; j++ ){
+            learnRow( net, chunk.x, chunk.target, j, code, label );
+          }
+          rows += chunk.x.rows;
+        }
+
+        int change = ART::totalChange( net ) + net.mapfield.changes;
+        StopReason reason = convergence.epoch( net, i, change );
+        progress.epoch( net, i, rows, change, reason );
+        if ( reason != STOP_NONE && reason != STOP_MAX_EPOCHS ) {
+          net.epochs = i;
+          break;
+        } else if ( i < ep ){
+          // as in ART::train, the counters of the last epoch are kept for inspection
+          for ( Module &module : net.modules ){
+            ART::changeReset( module );
+            ART::counterReset( module );
+          }
+          std::fill( net.mapfield.change.begin(), net.mapfield.change.end(), 0 );
+          net.mapfield.changes = 0;
+        }
+      }
+
+      // subset module weight matrix, counter and change vectors
+      for ( Module &module : net.modules ){
+        module.trim();
+      }
+
+      // subset mapfield weight matrix and change vector
+      if ( net.simplified ){
+        net.mapfield.label.resize( net.mapfield.numCategories );
+        net.mapfield.change.resize( net.mapfield.numCategories );
+      }
+      else{
+        standard::trim( net.mapfield );
+      }
+      if ( net.stats ){
+        net.stats->add( rows, timer.lap() );
+      }
+    }
+
+    // partialTrain: learn each row of x and its label once against the current state of the
+    // network, as the next part of a data stream. There is no epoch bookkeeping and the weight
+    // storage is not trimmed afterwards.
+    PartialTrainResult partialTrain( Network &net, Rows x, Rows target ){
+      checkTarget( net, x, target );
+      startStats( net );
+
+      PartialTrainResult result;
+      result.category.resize( x.rows );
+      result.newCategory.resize( x.rows );
+      result.time.resize( x.rows );
+
+      // the changes reported are those made by this part of the stream
+      for ( Module &module : net.modules ){
+        ART::changeReset( module );
+      }
+      std::fill( net.mapfield.change.begin(), net.mapfield.change.end(), 0 );
+      net.mapfield.changes = 0;
+
+      Module &module_a = net.modules[0];
+      std::vector< double > code( codeDimension( net.rule, net.dimension ) );
+      std::vector< double > label( codeDimension( net.rule, target.cols ) );
+      for ( int j = 0; j < x.rows; j++ ){
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        int nc = module_a.numCategories;
+        learnRow( net, x, target, j, code, label );
+        std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+
+        result.category[j] = module_a.Jmax[0];
+        result.newCategory[j] = module_a.numCategories > nc;
+        result.time[j] = std::chrono::duration< double, std::micro >( end - start ).count();
+      }
+
+      return result;
+    }
+
+    // predict: target may be empty (no rows), then matched is 0
+    Prediction predict( Network &net, Rows x, Rows target ){
+      checkNetwork( net );
+      if ( x.cols != net.dimension ){
+        throw std::invalid_argument( "The number of columns in the data must be the dimension of the network." );
+      }
+      bool test = target.rows > 0;
+      if ( test ){
+        checkTarget( net, x, target );
+      }
+      startStats( net );
+      PhaseTimer timer( net.stats != NULL );
+
+      Prediction p;
+      p.category_a.assign( x.rows, -1 );
+      p.matched.assign( x.rows, 0 );
+      std::vector< double > code( codeDimension( net.rule, net.dimension ) );
+
+      if ( net.simplified ){
+        p.predictedDimension = 1;
+        p.predicted.assign( x.rows, std::numeric_limits< double >::quiet_NaN() );
+        for ( int i = 0; i < x.rows; i++ ){
+          processCode( net.rule, x.row( i ), x.cols, code.data() );
+          int predicted = 0;
+          p.category_a[i] = simplified::classify( net, code.data(), predicted );
+          if ( p.category_a[i] != -1 ){
+            p.predicted[i] = predicted;
+          }
+          if ( test ){
+            p.matched[i] = p.category_a[i] != -1 && predicted == (int)target.row( i )[0] ? 1 : 0;
+          }
+        }
+      }
+      else{
+        std::vector< double > F1_b;
+        std::vector< double > label( codeDimension( net.rule, net.dimension ) );
+        std::vector< double > y( net.modules[1].weightDimension );
+        p.predictedDimension = 0;
+        for ( int i = 0; i < x.rows; i++ ){
+          processCode( net.rule, x.row( i ), x.cols, code.data() );
+          p.category_a[i] = standard::classify( net, code.data(), F1_b );
+          p.predictedDimension = unProcessCode( net.rule, F1_b.data(), F1_b.size(), y.data() );
+          p.predicted.insert( p.predicted.end(), y.begin(), y.begin() + p.predictedDimension );
+          if ( test ){
+            processCode( net.rule, target.row( i ), target.cols, label.data() );
+            p.matched[i] = standard::test( net, label.data() );
+          }
+        }
+      }
+
+      if ( net.stats ){
+        net.stats->add( x.rows, timer.lap() );
+      }
+      return p;
+    }
+
+  }
+
+}
@@ -0,0 +1,306 @@
+/****************************************************************************
+ *
+ *  core-compact.cpp
+ *  Renumbering and pruning the categories of trained networks
+ *
+ ****************************************************************************/
+
+#include <algorithm>
+#include <chrono>
+#include <stdexcept>
+#include <string>
+#include "core.h"
+
+namespace core {
+
+  namespace {
+
+    // remapMapfield: move the map field with the module a categories (rows) or, for the
+    // standard map field, the module b categories (columns)
+    void remapMapfield( Network &net, int id, const std::vector< int > &newIndices, int kept ){
+      Mapfield &mapfield = net.mapfield;
+      int l = newIndices.size();
+      if ( id == 0 && net.simplified ){
+        std::vector< int > label( kept ), change( kept );
+        for ( int k = 0; k < l; k++ ){
+          int j = newIndices[k];
+          if ( j == -1 ){
+            mapfield.changes -= mapfield.change[k];
+            continue;
+          }
+          label[j] = mapfield.label[k];
+          change[j] = mapfield.change[k];
+        }
+        mapfield.label.swap( label );
+        mapfield.change.swap( change );
+        mapfield.numCategories = kept;
+      }
+      else if ( id == 0 ){
+        int cols = mapfield.cols;
+        std::vector< double > w( (size_t)kept * cols );
+        std::vector< int > change( kept );
+        for ( int k = 0; k < l; k++ ){
+          int j = newIndices[k];
+          if ( j == -1 ){
+            mapfield.changes -= mapfield.change[k];
+            continue;
+          }
+          std::copy( mapfield.weight( k ), mapfield.weight( k ) + cols, &w[(size_t)j * cols] );
+          change[j] = mapfield.change[k];
+        }
+        mapfield.w.swap( w );
+        mapfield.change.swap( change );
+        mapfield.rows = kept;
+        mapfield.numCategories_a = kept;
+      }
+      else{
+        // the columns keep their capacity
+        std::vector< double > w( mapfield.w.size(), 0 );
+        for ( int a = 0; a < mapfield.rows; a++ ){
+          for ( int b = 0; b < l; b++ ){
+            if ( newIndices[b] != -1 ){
+              w[(size_t)a * mapfield.cols + newIndices[b]] = mapfield.weight( a )[b];
+            }
+          }
+        }
+        mapfield.w.swap( w );
+        mapfield.numCategories_b = kept;
+        mapfield.weightDimension = kept;
+      }
+    }
+
+    // predictRows: the module 0 categories of the rows of x (module a for ARTMAP) and, for ARTMAP
+    // with a target, whether each prediction matches it. Returns the seconds taken.
+    double predictRows( Network &net, Rows x, Rows target, std::vector< int > &category, std::vector< int > &matched ){
+      std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+      if ( net.type == NETWORK_ARTMAP ){
+        ARTMAP::Prediction p = ARTMAP::predict( net, x, target );
+        category.swap( p.category_a );
+        matched.swap( p.matched );
+      }
+      else{
+        category = ART::predict( net, 0, x );
+        matched.assign( x.rows, 0 );
+      }
+      return std::chrono::duration< double >( std::chrono::steady_clock::now() - start ).count();
+    }
+
+    // accuracy: the fraction of the rows whose prediction matches the target
+    double accuracy( const std::vector< int > &matched ){
+      long n = 0;
+      for ( int m : matched ){
+        n += m == 1;
+      }
+      return matched.empty() ? 0 : (double)n / matched.size();
+    }
+
+    // relearnRows: learn the rows in order by the module 0 categories they resonate with, for ARTMAP
+    // only if the category predicts their target. Returns the number of rows learned.
+    long relearnRows( Network &net, Rows x, Rows target ){
+      std::vector< int > category, matched;
+      predictRows( net, x, target, category, matched );
+      Module &module = net.modules[0];
+      std::vector< double > code( codeDimension( net.rule, net.dimension ) );
+      long learned = 0;
+      for ( int i = 0; i < x.rows; i++ ){
+        int J = category[i];
+        if ( J == -1 || ( net.type == NETWORK_ARTMAP && matched[i] != 1 ) ){
+          continue;
+        }
+        processCode( net.rule, x.row( i ), x.cols, code.data() );
+        // the rows learned before it may have moved the category out of its reach
+        if ( !( match( net.rule, module, code.data(), module.weight( J ) ) >= module.rho ) ){
+          continue;
+        }
+        ART::weightUpdate( net, module, J, code.data(), module.beta );
+        module.counter[J]++;
+        if ( net.type == NETWORK_TOPOART ){
+          module.n[J]++;
+        }
+        learned++;
+      }
+      return learned;
+    }
+
+  }
+
+  // categoryUsage: the number of rows each category of the module learned. For TopoART, this is
+  // the accumulator n, which counts them over all the epochs; otherwise the counter of the last epoch.
+  std::vector< int > categoryUsage( const Network &net, const Module &module ){
+    const std::vector< int > &u = net.type == NETWORK_TOPOART ? module.n : module.counter;
+    return std::vector< int >( u.begin(), u.begin() + std::min( (int)u.size(), module.numCategories ) );
+  }
+
+  // remapCategories: renumber the categories of module id. newIndices holds the new index of each
+  // category, or -1 if it is removed, and the new indices of the categories kept are 0, 1, ... in
+  // any order. The ARTMAP map field and the TopoART edges and linked clusters follow them.
+  void remapCategories( Network &net, int id, const std::vector< int > &newIndices ){
+    Module &module = net.modules[id];
+    int l = module.numCategories;
+    if ( (int)newIndices.size() != l ){
+      throw std::invalid_argument( "There must be a new index for each category." );
+    }
+    int kept = 0;
+    for ( int j : newIndices ){
+      kept += j != -1;
+    }
+    std::vector< bool > used( kept, false );
+    for ( int j : newIndices ){
+      if ( j < -1 || j >= kept || ( j != -1 && used[j] ) ){
+        throw std::invalid_argument( "The new indices must number the categories kept from 0." );
+      }
+      if ( j != -1 ){
+        used[j] = true;
+      }
+    }
+
+    int cols = module.weightDimension;
+    std::vector< double > w( (size_t)kept * cols );
+    std::vector< int > counter( kept ), change( kept ), n( kept, 0 );
+    for ( int k = 0; k < l; k++ ){
+      int j = newIndices[k];
+      if ( j == -1 ){
+        // the changes of a removed category leave the epoch counters
+        module.changes -= module.change[k];
+        module.changed -= module.change[k] > 0;
+        continue;
+      }
+      std::copy( module.weight( k ), module.weight( k ) + cols, &w[(size_t)j * cols] );
+      counter[j] = module.counter[k];
+      change[j] = module.change[k];
+      if ( k < (int)module.n.size() ){
+        n[j] = module.n[k];
+      }
+    }
+    module.w.swap( w );
+    module.counter.swap( counter );
+    module.change.swap( change );
+    module.n.swap( n );
+    module.numCategories = kept;
+    module.rows = kept;
+    for ( int &J : module.Jmax ){
+      J = J >= 0 && J < l ? newIndices[J] : -1;
+    }
+
+    if ( kept > 0 ){
+      module.edges.remap( newIndices );
+    }
+    else{
+      module.edges.clear();
+    }
+    if ( net.type == NETWORK_TOPOART ){
+      Topo::saveEdges( module );
+    }
+    if ( net.type == NETWORK_ARTMAP ){
+      remapMapfield( net, id, newIndices, kept );
+    }
+    module.clearBlocks();
+  }
+
+  // compact: remove the categories with a usage below minCounter (see categoryUsage), from every module
+  // but module b of ARTMAP, which holds the labels. With rows, they are predicted before and after
+  // to measure the trade-off, and with relearn, those whose module 0 category was removed are then
+  // learned by the kept categories they resonate with (see relearnRows); none are created for
+  // them. ARTMAP relearns against the target. With byUsage, the categories kept are ordered by
+  // their usage, the most used first, so the search meets the categories most rows resonate with
+  // together; with minCounter 0 nothing is removed, so it can be called between trainings only to
+  // reorder. A module whose usage is all zero cannot be filtered or ordered, so it is refused.
+  CompactReport compact( Network &net, int minCounter, Rows x, Rows target, bool relearn, bool byUsage ){
+    if ( minCounter < 0 ){
+      throw std::invalid_argument( "The minimum counter must not be negative." );
+    }
+    if ( x.rows > 0 && x.cols != net.dimension ){
+      throw std::invalid_argument( "The number of columns in the data must be the dimension of the network." );
+    }
+    if ( relearn && x.rows == 0 ){
+      throw std::invalid_argument( "The rows are needed to relearn." );
+    }
+    if ( relearn && net.type == NETWORK_ARTMAP && target.rows == 0 ){
+      throw std::invalid_argument( "The target is needed to relearn an ARTMAP network." );
+    }
+
+    CompactReport report = CompactReport();
+    report.measured = x.rows > 0;
+    report.tested = report.measured && net.type == NETWORK_ARTMAP && target.rows > 0;
+    std::vector< int > before, matchedBefore;
+    if ( report.measured ){
+      report.timeBefore = predictRows( net, x, target, before, matchedBefore );
+    }
+
+    int modules = net.type == NETWORK_ARTMAP ? 1 : net.numModules();
+    std::vector< std::vector< int > > usages( modules );
+    for ( int id = 0; id < modules; id++ ){
+      usages[id] = categoryUsage( net, net.modules[id] );
+      // counters reset by the last epoch would remove every category and order none
+      if ( ( minCounter > 0 || byUsage ) && !usages[id].empty() &&
+           std::all_of( usages[id].begin(), usages[id].end(), []( int u ) { return u == 0; } ) ){
+        throw std::invalid_argument( "The counters of module " + std::to_string( id ) +
+                                     " are all zero, so the usage of its categories is unknown." );
+      }
+    }
+
+    std::vector< int > kept0;
+    for ( int id = 0; id < modules; id++ ){
+      const Module &module = net.modules[id];
+      const std::vector< int > &used = usages[id];
+      std::vector< int > order;
+      for ( int k = 0; k < module.numCategories; k++ ){
+        if ( used[k] >= minCounter ){
+          order.push_back( k );
+        }
+      }
+      if ( byUsage ){
+        std::stable_sort( order.begin(), order.end(), [&used]( int i, int j ) { return used[i] > used[j]; } );
+      }
+      std::vector< int > newIndices( module.numCategories, -1 );
+      int kept = order.size();
+      for ( int j = 0; j < kept; j++ ){
+        newIndices[order[j]] = j;
+      }
+      report.categories.push_back( module.numCategories );
+      report.removed.push_back( module.numCategories - kept );
+      report.order.push_back( order );
+      remapCategories( net, id, newIndices );
+      if ( id == 0 ){
+        kept0.swap( newIndices );
+      }
+    }
+
+    if ( report.measured ){
+      // the rows of the removed categories
+      std::vector< double > rows, targets;
+      for ( int i = 0; i < x.rows; i++ ){
+        if ( before[i] != -1 && kept0[before[i]] == -1 ){
+          report.orphans++;
+          rows.insert( rows.end(), x.row( i ), x.row( i ) + x.cols );
+          if ( target.rows > 0 ){
+            targets.insert( targets.end(), target.row( i ), target.row( i ) + target.cols );
+          }
+        }
+      }
+      if ( relearn && report.orphans > 0 ){
+        report.relearned = relearnRows( net, Rows( rows.data(), report.orphans, x.cols ),
+                                         Rows( targets.data(), target.rows > 0 ? report.orphans : 0, target.cols ) );
+      }
+
+      std::vector< int > after, matchedAfter;
+      report.timeAfter = predictRows( net, x, target, after, matchedAfter );
+      long same = 0;
+      for ( int i = 0; i < x.rows; i++ ){
+        if ( before[i] == -1 ){
+          same += after[i] == -1;
+        }
+        else{
+          same += kept0[before[i]] != -1 && after[i] == kept0[before[i]];
+        }
+      }
+      report.agreement = (double)same / x.rows;
+      if ( report.tested ){
+        report.accuracyBefore = accuracy( matchedBefore );
+        report.accuracyAfter = accuracy( matchedAfter );
+      }
+    }
+    return report;
+  }
+
+}
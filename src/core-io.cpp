@@ -0,0 +1,602 @@
+/****************************************************************************
+ *
+ *  core-io.cpp
+ *  Reading and writing data files
+ *
+ *  Data sets are read from CSV files (an optional header row of column
+ *  names, empty or NA fields are missing values) or from binary row-major
+ *  matrix files, which are mapped into memory.
+ *
+ ****************************************************************************/
+
+#include <fstream>
+#include <iterator>
+#include <algorithm>
+#include <sstream>
+#include <cstring>
+#include <cstdlib>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+#include "core-io.h"
+#include "core-model.h"
+
+namespace core {
+
+  static_assert( sizeof( MatrixHeader ) == 64, "The matrix header must be 64 bytes." );
+
+  MappedFile::MappedFile( const std::string &file ) : data( NULL ), size( 0 ), mapped( false ){
+#ifndef _WIN32
+    int fd = open( file.c_str(), O_RDONLY );
+    if ( fd == -1 ){
+      throw std::runtime_error( "Can't open the file " + file + "." );
+    }
+    struct stat st;
+    if ( fstat( fd, &st ) == 0 && st.st_size > 0 ){
+      void *p = mmap( NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0 );
+      if ( p != MAP_FAILED ){
+        data = static_cast< const char * >( p );
+        size = st.st_size;
+        mapped = true;
+      }
+    }
+    close( fd );
+    if ( mapped ){
+      return;
+    }
+#endif
+    // the file can't be mapped, so read it into memory
+    std::ifstream in( file.c_str(), std::ios::binary );
+    if ( !in ){
+      throw std::runtime_error( "Can't open the file " + file + "." );
+    }
+    buffer.assign( std::istreambuf_iterator< char >( in ), std::istreambuf_iterator< char >() );
+    data = buffer.empty() ? NULL : &buffer[0];
+    size = buffer.size();
+  }
+
+  MappedFile::~MappedFile(){
+#ifndef _WIN32
+    if ( mapped ){
+      munmap( const_cast< char * >( data ), size );
+    }
+#endif
+  }
+
+  namespace {
+
+    // trim: strip the white space and the quotes around a field
+    std::string trim( const std::string &s ){
+      size_t b = s.find_first_not_of( " \t\r\"" );
+      if ( b == std::string::npos ){
+        return "";
+      }
+      size_t e = s.find_last_not_of( " \t\r\"" );
+      return s.substr( b, e - b + 1 );
+    }
+
+    // parseField: the value of a field, NaN for a missing value. Returns false if the field
+    // is not a number.
+    bool parseField( const std::string &field, double &value ){
+      std::string f = trim( field );
+      if ( f.empty() || f == "NA" || f == "NaN" ){
+        value = std::numeric_limits< double >::quiet_NaN();
+        return true;
+      }
+      char *end;
+      value = std::strtod( f.c_str(), &end );
+      return *end == '\0';
+    }
+
+    void split( const std::string &line, std::vector< std::string > &fields ){
+      fields.clear();
+      std::stringstream ss( line );
+      std::string field;
+      while ( std::getline( ss, field, ',' ) ){
+        fields.push_back( field );
+      }
+      if ( !line.empty() && line[line.size()-1] == ',' ){
+        fields.push_back( "" );
+      }
+    }
+  }
+
+  bool isCSV( const std::string &file ){
+    size_t dot = file.find_last_of( '.' );
+    if ( dot == std::string::npos ){
+      return false;
+    }
+    std::string ext = file.substr( dot + 1 );
+    return ext == "csv" || ext == "CSV" || ext == "txt";
+  }
+
+  CSVReader::CSVReader( const std::string &file ) : file( file ), in( file.c_str() ), numCols( 0 ), line( 0 ){
+    if ( !in ){
+      throw std::runtime_error( "Can't open the file " + file + "." );
+    }
+
+    // the number of columns is given by the first line, which is the header if it is not numeric
+    std::vector< double > values;
+    bool numeric;
+    start = in.tellg();
+    if ( readLine( values, numeric ) ){
+      if ( numeric ){
+        rewind();
+      }
+      else{
+        for ( const std::string &f : fields ){
+          names.push_back( trim( f ) );
+        }
+        start = in.tellg();
+      }
+    }
+  }
+
+  // readLine: parse the next non-empty line into values. Returns false at the end of the file.
+  bool CSVReader::readLine( std::vector< double > &values, bool &numeric ){
+    while ( std::getline( in, buffer ) ){
+      line++;
+      if ( trim( buffer ).empty() ){
+        continue;
+      }
+      split( buffer, fields );
+      if ( numCols == 0 ){
+        numCols = fields.size();
+      }
+      if ( (int)fields.size() != numCols ){
+        throw std::runtime_error( "Line " + std::to_string( line ) + " of " + file +
+                                  " does not have " + std::to_string( numCols ) + " fields." );
+      }
+      numeric = true;
+      for ( const std::string &f : fields ){
+        double v;
+        numeric = parseField( f, v ) && numeric;
+        values.push_back( v );
+      }
+      return true;
+    }
+    return false;
+  }
+
+  int CSVReader::read( std::vector< double > &values, int maxRows ){
+    int n = 0;
+    bool numeric;
+    while ( n < maxRows && readLine( values, numeric ) ){
+      if ( !numeric ){
+        throw std::runtime_error( "Line " + std::to_string( line ) + " of " + file + " is not numeric." );
+      }
+      n++;
+    }
+    return n;
+  }
+
+  void CSVReader::rewind(){
+    in.clear();
+    in.seekg( start );
+    line = names.empty() ? 0 : 1;
+  }
+
+  Matrix readCSV( const std::string &file ){
+    CSVReader reader( file );
+    Matrix m;
+    m.names = reader.names;
+    m.cols = reader.cols();
+    m.rows = reader.read( m.values, std::numeric_limits< int >::max() );
+    return m;
+  }
+
+  void writeCSV( const std::string &file, Rows x, const std::vector< std::string > &names ){
+    std::ofstream out( file.c_str(), std::ios::trunc );
+    if ( !out ){
+      throw std::runtime_error( "Can't open the file " + file + " for writing." );
+    }
+    out.precision( 15 );
+    for ( size_t j = 0; j < names.size(); j++ ){
+      out << ( j > 0 ? "," : "" ) << names[j];
+    }
+    if ( !names.empty() ){
+      out << "\n";
+    }
+    for ( int i = 0; i < x.rows; i++ ){
+      const double *r = x.row( i );
+      for ( int j = 0; j < x.cols; j++ ){
+        if ( j > 0 ) out << ",";
+        if ( std::isnan( r[j] ) ) out << "NA";
+        else out << r[j];
+      }
+      out << "\n";
+    }
+    if ( !out ){
+      throw std::runtime_error( "Failed to write the file " + file + "." );
+    }
+  }
+
+  MatrixReader::MatrixReader( const std::string &file ) : file( file ), in( file.c_str(), std::ios::binary ), position( 0 ){
+    if ( !isLittleEndian() ){
+      throw std::runtime_error( "Matrix files can only be read on little-endian machines." );
+    }
+    if ( !in ){
+      throw std::runtime_error( "Can't open the file " + file + "." );
+    }
+    MatrixHeader h;
+    in.read( reinterpret_cast< char * >( &h ), sizeof( h ) );
+    if ( !in || std::memcmp( h.magic, MATRIX_MAGIC, sizeof( h.magic ) ) != 0 || h.byteOrder != MODEL_BYTE_ORDER ){
+      throw std::runtime_error( "The file " + file + " is not a matrix file." );
+    }
+    if ( h.version > MATRIX_VERSION ){
+      throw std::runtime_error( "The matrix file was written by a newer version of rART." );
+    }
+    numCols = h.cols;
+    numRows = h.rows;
+  }
+
+  int MatrixReader::read( std::vector< double > &values, int maxRows ){
+    uint64_t n = std::min( (uint64_t)maxRows, numRows - position );
+    if ( n == 0 ){
+      return 0;
+    }
+    size_t size = values.size();
+    values.resize( size + n * numCols );
+    in.read( reinterpret_cast< char * >( &values[size] ), n * numCols * sizeof( double ) );
+    if ( !in ){
+      throw std::runtime_error( "The matrix file " + file + " is truncated." );
+    }
+    position += n;
+    return n;
+  }
+
+  void MatrixReader::rewind(){
+    in.clear();
+    in.seekg( sizeof( MatrixHeader ) );
+    position = 0;
+  }
+
+  // mappedRows: the rows of a mapped binary matrix file
+  static Rows mappedRows( const MappedFile &f, const std::string &file ){
+    if ( !isLittleEndian() ){
+      throw std::runtime_error( "Matrix files can only be read on little-endian machines." );
+    }
+    const MatrixHeader *h = reinterpret_cast< const MatrixHeader * >( f.data );
+    if ( f.size < sizeof( MatrixHeader ) || std::memcmp( h->magic, MATRIX_MAGIC, sizeof( h->magic ) ) != 0 ||
+         h->byteOrder != MODEL_BYTE_ORDER ){
+      throw std::runtime_error( "The file " + file + " is not a matrix file." );
+    }
+    if ( h->version > MATRIX_VERSION ){
+      throw std::runtime_error( "The matrix file was written by a newer version of rART." );
+    }
+    if ( sizeof( MatrixHeader ) + h->rows * h->cols * sizeof( double ) > f.size ){
+      throw std::runtime_error( "The matrix file " + file + " is truncated." );
+    }
+
+    return Rows( reinterpret_cast< const double * >( f.data + sizeof( MatrixHeader ) ), h->rows, h->cols );
+  }
+
+  Matrix readMatrix( const std::string &file ){
+    MappedFile f( file );
+    Rows x = mappedRows( f, file );
+    Matrix m;
+    m.rows = x.rows;
+    m.cols = x.cols;
+    m.values.assign( x.data, x.data + (size_t)x.rows * x.cols );
+    return m;
+  }
+
+  void writeMatrix( const std::string &file, Rows x ){
+    if ( !isLittleEndian() ){
+      throw std::runtime_error( "Matrix files can only be written on little-endian machines." );
+    }
+    MatrixHeader h;
+    std::memset( &h, 0, sizeof( h ) );
+    std::memcpy( h.magic, MATRIX_MAGIC, sizeof( h.magic ) );
+    h.version = MATRIX_VERSION;
+    h.byteOrder = MODEL_BYTE_ORDER;
+    h.rows = x.rows;
+    h.cols = x.cols;
+
+    std::ofstream out( file.c_str(), std::ios::binary | std::ios::trunc );
+    if ( !out ){
+      throw std::runtime_error( "Can't open the file " + file + " for writing." );
+    }
+    out.write( reinterpret_cast< const char * >( &h ), sizeof( h ) );
+    out.write( reinterpret_cast< const char * >( x.data ), (size_t)x.rows * x.cols * sizeof( double ) );
+    if ( !out ){
+      throw std::runtime_error( "Failed to write the file " + file + "." );
+    }
+  }
+
+  namespace {
+
+    // the smallest part of a CSV file worth a thread of its own
+    const size_t MIN_PART_SIZE = 1 << 20;
+
+    /* CSVPart: a part of a CSV file, its rows parsed into out, with the ranges of their columns */
+    struct CSVPart {
+      const char *begin;
+      const char *end;
+      double *out;          // the place of the first row of the part in the matrix of all the rows
+      std::vector< double > minimum;
+      std::vector< double > maximum;
+      int rows;
+      long lines;           // the number of lines parsed, including the empty ones
+      std::string error;    // the first error, on the last line parsed
+    };
+
+    // nextLine: the start of the line after p
+    const char *nextLine( const char *p, const char *end ){
+      const char *n = static_cast< const char * >( std::memchr( p, '\n', end - p ) );
+      return n == NULL ? end : n + 1;
+    }
+
+    // blank: whether the line from p to end has only white space
+    bool blank( const char *p, const char *end ){
+      for ( ; p < end; p++ ){
+        if ( *p != ' ' && *p != '\t' && *p != '\r' && *p != '\n' ){
+          return false;
+        }
+      }
+      return true;
+    }
+
+    // countRows: the number of rows of a part, its lines that are not blank
+    int countRows( const CSVPart &part ){
+      int rows = 0;
+      for ( const char *p = part.begin; p < part.end; ){
+        const char *n = nextLine( p, part.end );
+        rows += !blank( p, n );
+        p = n;
+      }
+      return rows;
+    }
+
+    // parseFields: append the fields of a line to values. Returns the number of fields, or -1 if
+    // a field is not a number.
+    int parseFields( const std::string &line, std::vector< double > &values ){
+      int n = 0;
+      const char *p = line.c_str();
+      while ( true ){
+        const char *e = std::strchr( p, ',' );
+        if ( e == NULL ){
+          e = p + std::strlen( p );
+        }
+        const char *b = p;
+        const char *t = e;
+        while ( b < t && std::strchr( " \t\r\"", *b ) ) b++;
+        while ( t > b && std::strchr( " \t\r\"", *( t - 1 ) ) ) t--;
+        double v;
+        if ( b == t || ( t - b == 2 && std::strncmp( b, "NA", 2 ) == 0 ) || ( t - b == 3 && std::strncmp( b, "NaN", 3 ) == 0 ) ){
+          v = std::numeric_limits< double >::quiet_NaN();
+        }
+        else{
+          char *end;
+          v = std::strtod( b, &end );
+          if ( end != t ){
+            return -1;
+          }
+        }
+        values.push_back( v );
+        n++;
+        if ( *e == '\0' ){
+          return n;
+        }
+        p = e + 1;
+      }
+    }
+
+    // parsePart: parse the rows of a part into part.out, which has room for the rows counted
+    void parsePart( CSVPart &part, int cols ){
+      std::string line;
+      std::vector< double > values;
+      part.minimum.assign( cols, std::numeric_limits< double >::infinity() );
+      part.maximum.assign( cols, -std::numeric_limits< double >::infinity() );
+      for ( const char *p = part.begin; p < part.end; ){
+        const char *n = nextLine( p, part.end );
+        part.lines++;
+        if ( blank( p, n ) ){
+          p = n;
+          continue;
+        }
+        line.assign( p, n - p );
+        p = n;
+        if ( line[line.size()-1] == '\n' ){
+          line.erase( line.size() - 1 );
+        }
+        values.clear();
+        int fields = parseFields( line, values );
+        if ( fields == -1 ){
+          part.error = " is not numeric.";
+          return;
+        }
+        if ( fields != cols ){
+          part.error = " does not have " + std::to_string( cols ) + " fields.";
+          return;
+        }
+        double *out = part.out + (size_t)part.rows * cols;
+        for ( int j = 0; j < cols; j++ ){
+          double v = values[j];
+          out[j] = v;
+          if ( !std::isnan( v ) ){
+            part.minimum[j] = std::min( part.minimum[j], v );
+            part.maximum[j] = std::max( part.maximum[j], v );
+          }
+        }
+        part.rows++;
+      }
+    }
+
+    // scale: copy the rows of x into out, scaled to [0, 1] by the ranges
+    void scale( Rows x, const std::vector< double > &minimum, const std::vector< double > &maximum, double *out ){
+      for ( int i = 0; i < x.rows; i++ ){
+        const double *r = x.row( i );
+        double *o = out + (size_t)i * x.cols;
+        for ( int j = 0; j < x.cols; j++ ){
+          double d = maximum[j] - minimum[j];
+          o[j] = d > 0 ? ( r[j] - minimum[j] )/d : ( std::isnan( r[j] ) ? r[j] : 0 );
+        }
+      }
+    }
+
+    // normalizeParts: put the parts together into data, scaled by the given ranges or by the
+    // ranges of the parts, with one thread per part. The parts may already be the rows of
+    // data.values, in order and of its size, and are then scaled in place.
+    void normalizeParts( const std::vector< Rows > &parts, const std::vector< std::vector< double > > &minima,
+                         const std::vector< std::vector< double > > &maxima, int cols, NormalizedData &data ){
+      std::vector< double > low( cols, std::numeric_limits< double >::infinity() );
+      std::vector< double > high( cols, -std::numeric_limits< double >::infinity() );
+      for ( size_t k = 0; k < parts.size(); k++ ){
+        for ( int j = 0; j < cols; j++ ){
+          low[j] = std::min( low[j], minima[k][j] );
+          high[j] = std::max( high[j], maxima[k][j] );
+        }
+      }
+      if ( data.minimum.empty() ){
+        data.minimum = low;
+        data.maximum = high;
+      }
+      else if ( (int)data.minimum.size() != cols || (int)data.maximum.size() != cols ){
+        throw std::invalid_argument( "The ranges must have a value for each column of the data." );
+      }
+
+      // the ranges of the scaled columns follow from the ranges of the raw columns
+      data.low.resize( cols );
+      data.high.resize( cols );
+      scale( Rows( low.data(), 1, cols ), data.minimum, data.maximum, data.low.data() );
+      scale( Rows( high.data(), 1, cols ), data.minimum, data.maximum, data.high.data() );
+
+      std::vector< size_t > offset( parts.size() + 1, 0 );
+      for ( size_t k = 0; k < parts.size(); k++ ){
+        offset[k+1] = offset[k] + parts[k].rows;
+      }
+      data.rows = offset.back();
+      data.cols = cols;
+      data.values.resize( (size_t)data.rows * cols );
+      parallel( parts.size(), [&]( int k ){
+        scale( parts[k], data.minimum, data.maximum, &data.values[offset[k] * cols] );
+      } );
+    }
+
+    void normalizeCSV( const std::string &file, NormalizedData &data, int threads ){
+      MappedFile f( file );
+      const char *begin = f.data;
+      const char *end = f.data + f.size;
+
+      // the first non-empty line gives the number of columns, and it is the header if it is not numeric
+      std::vector< double > values;
+      std::string line;
+      std::vector< std::string > fields;
+      long headerLines = 0;
+      const char *p = begin;
+      int cols = 0;
+      while ( p < end && cols == 0 ){
+        const char *n = nextLine( p, end );
+        line.assign( p, n - p );
+        if ( line.find_first_not_of( " \t\r\n" ) == std::string::npos ){
+          p = n;
+          headerLines++;
+          continue;
+        }
+        if ( line[line.size()-1] == '\n' ){
+          line.erase( line.size() - 1 );
+        }
+        split( line, fields );
+        cols = fields.size();
+        values.clear();
+        if ( parseFields( line, values ) == -1 ){
+          for ( const std::string &field : fields ){
+            data.names.push_back( trim( field ) );
+          }
+          p = n;
+          headerLines++;
+        }
+      }
+
+      // split the rest into parts at line boundaries
+      size_t size = end - p;
+      int numParts = std::max( (size_t)1, std::min( (size_t)numThreads( threads ), size / MIN_PART_SIZE ) );
+      std::vector< CSVPart > parts( numParts );
+      for ( int k = 0; k < numParts; k++ ){
+        parts[k].begin = k == 0 ? p : parts[k-1].end;
+        parts[k].end = k == numParts - 1 ? end : nextLine( std::max( parts[k].begin, p + size/numParts*( k + 1 ) - 1 ), end );
+        parts[k].rows = 0;
+        parts[k].lines = 0;
+      }
+
+      // count the rows of each part first, so that each part is parsed straight into its place
+      // in data.values and the matrix is held only once
+      std::vector< int > counts( numParts );
+      parallel( numParts, [&]( int k ){ counts[k] = countRows( parts[k] ); } );
+      size_t total = 0;
+      for ( int k = 0; k < numParts; k++ ){
+        total += counts[k];
+      }
+      data.values.resize( total * cols );
+      size_t offset = 0;
+      for ( int k = 0; k < numParts; k++ ){
+        parts[k].out = data.values.data() + offset * cols;
+        offset += counts[k];
+      }
+      parallel( numParts, [&]( int k ){ parsePart( parts[k], cols ); } );
+
+      std::vector< Rows > rows;
+      std::vector< std::vector< double > > minima, maxima;
+      long lines = headerLines;
+      for ( CSVPart &part : parts ){
+        if ( !part.error.empty() ){
+          throw std::runtime_error( "Line " + std::to_string( lines + part.lines ) + " of " + file + part.error );
+        }
+        lines += part.lines;
+        rows.push_back( Rows( part.out, part.rows, cols ) );
+        minima.push_back( part.minimum );
+        maxima.push_back( part.maximum );
+      }
+      normalizeParts( rows, minima, maxima, cols, data );
+    }
+
+    void normalizeMatrix( const std::string &file, NormalizedData &data, int threads ){
+      MappedFile f( file );
+      Rows x = mappedRows( f, file );
+      int numParts = std::max( 1, std::min( numThreads( threads ), x.rows ) );
+      std::vector< Rows > rows( numParts );
+      std::vector< std::vector< double > > minima( numParts ), maxima( numParts );
+      parallel( numParts, [&]( int k ){
+        int first = (long)x.rows * k / numParts;
+        int last = (long)x.rows * ( k + 1 ) / numParts;
+        rows[k] = Rows( x.row( first ), last - first, x.cols );
+        columnRange( rows[k], minima[k], maxima[k] );
+      } );
+      normalizeParts( rows, minima, maxima, x.cols, data );
+    }
+  }
+
+  NormalizedData readNormalized( const std::string &file, const std::vector< double > &minimum,
+                                 const std::vector< double > &maximum, int threads ){
+    NormalizedData data;
+    data.minimum = minimum;
+    data.maximum = maximum;
+    if ( isCSV( file ) ){
+      normalizeCSV( file, data, threads );
+    }
+    else{
+      normalizeMatrix( file, data, threads );
+    }
+    return data;
+  }
+
+  std::unique_ptr< RowReader > openRows( const std::string &file ){
+    if ( isCSV( file ) ){
+      return std::unique_ptr< RowReader >( new CSVReader( file ) );
+    }
+    return std::unique_ptr< RowReader >( new MatrixReader( file ) );
+  }
+
+  // readData: read a CSV file or a binary matrix file, by the file extension
+  Matrix readData( const std::string &file ){
+    return isCSV( file ) ? readCSV( file ) : readMatrix( file );
+  }
+
+}
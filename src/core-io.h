@@ -0,0 +1,131 @@
+/****************************************************************************
+ *
+ *  core-io.h
+ *  Reading and writing data files
+ *
+ ****************************************************************************/
+
+#ifndef CORE_IO_H
+#define CORE_IO_H
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <fstream>
+#include <memory>
+#include "core.h"
+
+namespace core {
+
+  /* The binary matrix format (version 1), little-endian: a 64 byte header followed by the
+     values as doubles, row by row. */
+  const char MATRIX_MAGIC[8] = { 'r', 'A', 'R', 'T', 'm', 'a', 't', '\0' };
+  const uint32_t MATRIX_VERSION = 1;
+
+  struct MatrixHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t byteOrder;
+    uint64_t rows;
+    uint64_t cols;
+    char padding[32];
+  };
+
+  /* MappedFile: a read-only memory mapping of a whole file */
+  struct MappedFile {
+    const char *data;
+    size_t size;
+
+    explicit MappedFile( const std::string &file );
+    ~MappedFile();
+
+  private:
+    MappedFile( const MappedFile & );
+    MappedFile &operator=( const MappedFile & );
+    std::vector< char > buffer; // used when the file can't be mapped
+    bool mapped;
+  };
+
+  /* Matrix: a row-major matrix that owns its values, with optional column names */
+  struct Matrix {
+    std::vector< double > values;
+    int rows;
+    int cols;
+    std::vector< std::string > names;
+
+    Matrix() : rows( 0 ), cols( 0 ) {}
+    Rows view() const { return Rows( values.data(), rows, cols ); }
+  };
+
+  /* RowReader: reads the rows of a data file in order, a number of rows at a time */
+  struct RowReader {
+    std::vector< std::string > names;  // the column names, if the file has them
+
+    virtual ~RowReader() {}
+    virtual int cols() const = 0;
+    // read: append up to maxRows rows to values and return the number of rows read, 0 at the end
+    virtual int read( std::vector< double > &values, int maxRows ) = 0;
+    virtual void rewind() = 0;
+  };
+
+  /* CSVReader: an optional header row of column names, empty or NA fields are missing values */
+  struct CSVReader : RowReader {
+    explicit CSVReader( const std::string &file );
+    int cols() const { return numCols; }
+    int read( std::vector< double > &values, int maxRows );
+    void rewind();
+
+  private:
+    bool readLine( std::vector< double > &values, bool &numeric );
+    std::string file;
+    std::ifstream in;
+    std::streampos start;   // the first data line
+    int numCols;
+    long line;
+    std::string buffer;
+    std::vector< std::string > fields;
+  };
+
+  /* MatrixReader: the rows of a binary matrix file */
+  struct MatrixReader : RowReader {
+    explicit MatrixReader( const std::string &file );
+    int cols() const { return numCols; }
+    int read( std::vector< double > &values, int maxRows );
+    void rewind();
+
+  private:
+    std::string file;
+    std::ifstream in;
+    int numCols;
+    uint64_t numRows;
+    uint64_t position;
+  };
+
+  /* NormalizedData: a data set scaled column by column to [0, 1] by its minimum and maximum, as
+     normalize does in R. The ranges can also be given, e.g. those of the training set for a test
+     set, in which case the values can fall outside [0, 1]. A column with a single value is 0. */
+  struct NormalizedData : Matrix {
+    std::vector< double > minimum;  // the ranges used for the scaling
+    std::vector< double > maximum;
+    std::vector< double > low;      // the ranges of the scaled columns, e.g. for R_bar
+    std::vector< double > high;
+  };
+
+  // readNormalized: read and normalize a CSV file or a binary matrix file with several threads
+  // (all the hardware threads if threads is 0)
+  NormalizedData readNormalized( const std::string &file, const std::vector< double > &minimum = std::vector< double >(),
+                                 const std::vector< double > &maximum = std::vector< double >(), int threads = 0 );
+
+  // openRows: a reader for a CSV file or a binary matrix file, by the file extension
+  std::unique_ptr< RowReader > openRows( const std::string &file );
+
+  bool isCSV( const std::string &file );
+  Matrix readCSV( const std::string &file );
+  void writeCSV( const std::string &file, Rows x, const std::vector< std::string > &names );
+  Matrix readMatrix( const std::string &file );
+  void writeMatrix( const std::string &file, Rows x );
+  Matrix readData( const std::string &file );
+
+}
+
+#endif
@@ -0,0 +1,652 @@
+/****************************************************************************
+ *
+ *  core-model.cpp
+ *  Binary model files
+ *
+ *  Writes and reads the record tree of a model file, and converts a native
+ *  network to and from the tree with the layout of the R network object.
+ *
+ ****************************************************************************/
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#include <process.h>
+#else
+#include <unistd.h>
+#endif
+#include "core-model.h"
+
+namespace core {
+
+  static_assert( sizeof( ModelHeader ) == 64, "The model header must be 64 bytes." );
+  static_assert( sizeof( ModelRecord ) == 64, "A model record must be 64 bytes." );
+
+  bool isLittleEndian(){
+    uint32_t one = 1;
+    return *reinterpret_cast< char * >( &one ) == 1;
+  }
+
+  namespace {
+
+    // temporaryName: a name next to file that no other writer uses, of this or another process
+    std::string temporaryName( const std::string &file ){
+      static std::atomic< unsigned > counter( 0 );
+#ifdef _WIN32
+      long pid = _getpid();
+#else
+      long pid = getpid();
+#endif
+      return file + "." + std::to_string( pid ) + "." + std::to_string( counter++ ) + ".tmp";
+    }
+
+    // replaceFile: move the file from over the file to, which may exist. rename does not replace
+    // an existing file on Windows; there no mapping holds it open (see MappedFile).
+    bool replaceFile( const std::string &from, const std::string &to ){
+#ifdef _WIN32
+      return MoveFileExA( from.c_str(), to.c_str(), MOVEFILE_REPLACE_EXISTING ) != 0;
+#else
+      return std::rename( from.c_str(), to.c_str() ) == 0;
+#endif
+    }
+
+    uint64_t align( uint64_t offset ){
+      return ( offset + MODEL_ALIGNMENT - 1 ) / MODEL_ALIGNMENT * MODEL_ALIGNMENT;
+    }
+
+    std::string encodeStrings( const std::vector< std::string > &v ){
+      std::string s;
+      for ( const std::string &e : v ){
+        s.append( e );
+        s.push_back( '\0' );
+      }
+      return s;
+    }
+  }
+
+  int ModelWriter::add( int type, const std::string &name, int parent, bool attribute, int length,
+                        const void *data, size_t bytes ){
+    if ( name.size() >= sizeof( ModelRecord().name ) ){
+      throw std::invalid_argument( "The attribute name " + name + " is too long to be saved in a model file." );
+    }
+
+    ModelRecord r;
+    std::memset( &r, 0, sizeof( r ) );
+    std::strncpy( r.name, name.c_str(), sizeof( r.name ) - 1 );
+    r.parent = parent;
+    r.type = type;
+    r.flags = attribute ? RECORD_ATTRIBUTE : 0;
+    r.length = length;
+    r.bytes = bytes;
+
+    records.push_back( r );
+    borrowed.push_back( static_cast< const char * >( data ) );
+    owned.push_back( std::string() );
+    return records.size() - 1;
+  }
+
+  int ModelWriter::addOwned( int type, const std::string &name, int parent, bool attribute, int length, const std::string &data ){
+    int index = add( type, name, parent, attribute, length, NULL, data.size() );
+    owned[index] = data;
+    return index;
+  }
+
+  void ModelWriter::setMatrix( int index, int nrow, int ncol, bool rowMajor ){
+    records[index].flags |= RECORD_MATRIX | ( rowMajor ? RECORD_ROW_MAJOR : 0 );
+    records[index].nrow = nrow;
+    records[index].ncol = ncol;
+  }
+
+  void ModelWriter::write( const std::string &file ){
+    if ( !isLittleEndian() ){
+      throw std::runtime_error( "Model files can only be written on little-endian machines." );
+    }
+
+    // lay out the data blocks after the record table, each aligned to 64 bytes
+    uint64_t offset = align( sizeof( ModelHeader ) + records.size() * sizeof( ModelRecord ) );
+    for ( size_t i = 0; i < records.size(); i++ ){
+      if ( records[i].bytes > 0 ){
+        records[i].offset = offset;
+        offset = align( offset + records[i].bytes );
+      }
+    }
+
+    ModelHeader h;
+    std::memset( &h, 0, sizeof( h ) );
+    std::memcpy( h.magic, MODEL_MAGIC, sizeof( h.magic ) );
+    h.version = MODEL_VERSION;
+    h.byteOrder = MODEL_BYTE_ORDER;
+    h.numRecords = records.size();
+    h.tableOffset = sizeof( ModelHeader );
+    h.fileSize = offset;
+
+    // the file is written aside and renamed over the old one, which a network loaded from it may
+    // still be viewing (see loadNetwork)
+    std::string temporary = temporaryName( file );
+    std::ofstream out( temporary.c_str(), std::ios::binary | std::ios::trunc );
+    if ( !out ){
+      throw std::runtime_error( "Can't open the file " + file + " for writing." );
+    }
+    out.write( reinterpret_cast< const char * >( &h ), sizeof( h ) );
+    out.write( reinterpret_cast< const char * >( records.data() ), records.size() * sizeof( ModelRecord ) );
+
+    static const char zeros[MODEL_ALIGNMENT] = { 0 };
+    uint64_t position = sizeof( ModelHeader ) + records.size() * sizeof( ModelRecord );
+    for ( size_t i = 0; i < records.size(); i++ ){
+      if ( records[i].bytes > 0 ){
+        out.write( zeros, records[i].offset - position );
+        const char *data = borrowed[i] != NULL ? borrowed[i] : owned[i].data();
+        out.write( data, records[i].bytes );
+        position = records[i].offset + records[i].bytes;
+      }
+    }
+    out.write( zeros, h.fileSize - position );
+
+    out.close();
+    if ( !out || !replaceFile( temporary, file ) ){
+      std::remove( temporary.c_str() );
+      throw std::runtime_error( "Failed to write the file " + file + "." );
+    }
+  }
+
+  ModelFile::ModelFile( const std::string &path ) : file( path ), header( NULL ){
+    if ( !isLittleEndian() ){
+      throw std::runtime_error( "Model files can only be read on little-endian machines." );
+    }
+    if ( file.size < sizeof( ModelHeader ) ){
+      throw std::runtime_error( "The file " + path + " is not a model file." );
+    }
+    header = reinterpret_cast< const ModelHeader * >( file.data );
+    if ( std::memcmp( header->magic, MODEL_MAGIC, sizeof( header->magic ) ) != 0 || header->byteOrder != MODEL_BYTE_ORDER ){
+      throw std::runtime_error( "The file " + path + " is not a model file." );
+    }
+    if ( header->version > MODEL_VERSION ){
+      throw std::runtime_error( "The model file was written by a newer version of rART." );
+    }
+    if ( header->numRecords == 0 || header->tableOffset + (uint64_t)header->numRecords * sizeof( ModelRecord ) > file.size ){
+      throw std::runtime_error( "The model file is truncated." );
+    }
+
+    // check every record before building anything from it
+    int n = header->numRecords;
+    records.resize( n );
+    children.resize( n );
+    for ( int i = 0; i < n; i++ ){
+      const ModelRecord *r = reinterpret_cast< const ModelRecord * >( file.data + header->tableOffset ) + i;
+      if ( r->offset + r->bytes > file.size || r->length < 0 || ( i > 0 && ( r->parent < 0 || r->parent >= i ) ) ){
+        throw std::runtime_error( "The model file is corrupt." );
+      }
+      size_t width = ( r->type == RECORD_DOUBLE ) ? sizeof( double ) : sizeof( int );
+      if ( ( r->type == RECORD_INTEGER || r->type == RECORD_DOUBLE || r->type == RECORD_LOGICAL ) &&
+           r->bytes != r->length * width ){
+        throw std::runtime_error( "The model file is corrupt." );
+      }
+      if ( ( r->flags & RECORD_MATRIX ) && ( r->nrow < 0 || r->ncol < 0 || (int64_t)r->nrow * r->ncol != r->length ) ){
+        throw std::runtime_error( "The model file is corrupt." );
+      }
+      records[i] = r;
+      if ( i > 0 ){
+        children[r->parent].push_back( i );
+      }
+    }
+  }
+
+  // strings: the values of a string record, NA is returned as a single 0xFF character
+  std::vector< std::string > ModelFile::strings( int index ) const {
+    const ModelRecord &r = *records[index];
+    std::vector< std::string > v;
+    const char *p = data( index );
+    const char *end = p + r.bytes;
+    for ( int i = 0; i < r.length && p < end; i++ ){
+      size_t l = strnlen( p, end - p );
+      v.push_back( std::string( p, l ) );
+      p += l + 1;
+    }
+    return v;
+  }
+
+  // attribute: the record of the named attribute, -1 if there is none
+  int ModelFile::attribute( int index, const std::string &name ) const {
+    for ( int c : children[index] ){
+      if ( isAttribute( c ) && name == records[c]->name ){
+        return c;
+      }
+    }
+    return -1;
+  }
+
+  // elements: the records of the elements of a list
+  std::vector< int > ModelFile::elements( int list ) const {
+    std::vector< int > e;
+    for ( int c : children[list] ){
+      if ( !isAttribute( c ) ){
+        e.push_back( c );
+      }
+    }
+    return e;
+  }
+
+  // element: the record of the named list element, -1 if there is none
+  int ModelFile::element( int list, const std::string &name ) const {
+    int names = attribute( list, "names" );
+    if ( names == -1 || records[names]->type != RECORD_STRING ){
+      return -1;
+    }
+    std::vector< std::string > n = strings( names );
+    std::vector< int > e = elements( list );
+    for ( size_t i = 0; i < n.size() && i < e.size(); i++ ){
+      if ( n[i] == name ){
+        return e[i];
+      }
+    }
+    return -1;
+  }
+
+  namespace {
+
+    /* Writing: the records of a named list are added element by element, followed by the
+       names attribute */
+    struct ListWriter {
+      ModelWriter &writer;
+      int index;
+      std::vector< std::string > names;
+
+      ListWriter( ModelWriter &writer, const std::string &name, int parent, bool attribute, int length ) :
+        writer( writer ), index( writer.add( RECORD_LIST, name, parent, attribute, length ) ) {}
+
+      int add( const std::string &name, int type, int length, const std::string &data ){
+        names.push_back( name );
+        return writer.addOwned( type, "", index, false, length, data );
+      }
+      void integer( const std::string &name, int x ){
+        add( name, RECORD_INTEGER, 1, std::string( reinterpret_cast< const char * >( &x ), sizeof( x ) ) );
+      }
+      void real( const std::string &name, double x ){
+        add( name, RECORD_DOUBLE, 1, std::string( reinterpret_cast< const char * >( &x ), sizeof( x ) ) );
+      }
+      int integers( const std::string &name, const std::vector< int > &x ){
+        return add( name, RECORD_INTEGER, x.size(), std::string( reinterpret_cast< const char * >( x.data() ), x.size() * sizeof( int ) ) );
+      }
+      // matrix: a row-major matrix, stored as it is. The values are borrowed.
+      void matrix( const std::string &name, const double *x, int nrow, int ncol ){
+        names.push_back( name );
+        size_t length = (size_t)nrow * ncol;
+        int r = writer.add( RECORD_DOUBLE, "", index, false, length, x, length * sizeof( double ) );
+        writer.setMatrix( r, nrow, ncol, true );
+      }
+      int list( const std::string &name, int length ){
+        names.push_back( name );
+        return writer.add( RECORD_LIST, "", index, false, length );
+      }
+      void close(){
+        writer.addOwned( RECORD_STRING, "names", index, true, names.size(), encodeStrings( names ) );
+      }
+    };
+
+    void attribute( ModelWriter &writer, int parent, const std::string &name, const std::string &value ){
+      writer.addOwned( RECORD_STRING, name, parent, true, 1, encodeStrings( std::vector< std::string >( 1, value ) ) );
+    }
+
+    void writeModule( ModelWriter &writer, int parent, const Network &net, const Module &module ){
+      bool topo = net.type == NETWORK_TOPOART;
+      int length = 12 + ( topo ? 6 : 0 ) + ( module.hasR_bar ? 1 : 0 );
+      ListWriter l( writer, "", parent, false, length );
+      std::vector< int > counter( module.counter.begin(), module.counter.begin() + module.rows );
+      std::vector< int > change( module.change.begin(), module.change.begin() + module.rows );
+      l.integer( "id", module.id );
+      l.integer( "weightDimension", module.weightDimension );
+      l.integer( "capacity", module.capacity );
+      l.integer( "numCategories", module.numCategories );
+      l.real( "alpha", module.alpha );
+      l.real( "epsilon", module.epsilon );
+      l.matrix( "w", module.w.data(), module.rows, module.weightDimension );
+      l.real( "rho", module.rho );
+      l.real( "beta", module.beta );
+      l.integers( "Jmax", module.Jmax );
+      l.integers( "counter", counter );
+      l.integers( "change", change );
+      if ( topo ){
+        int e = l.integers( "edge", module.edges.nodes );
+        if ( !module.edges.nodes.empty() ){
+          writer.setMatrix( e, 2, module.edges.nodes.size()/2 );
+        }
+        l.real( "beta1", module.beta1 );
+        l.real( "beta2", module.beta2 );
+        int c = l.list( "linkedClusters", module.linkedClusters.size() );
+        for ( const std::vector< int > &cluster : module.linkedClusters ){
+          writer.addOwned( RECORD_INTEGER, "", c, false, cluster.size(),
+                           std::string( reinterpret_cast< const char * >( cluster.data() ), cluster.size() * sizeof( int ) ) );
+        }
+        l.integers( "n", std::vector< int >( module.n.begin(), module.n.begin() + module.rows ) );
+        l.integer( "phi", module.phi );
+      }
+      if ( module.hasR_bar ){
+        l.real( "R_bar", module.R_bar );
+      }
+      l.close();
+      attribute( writer, l.index, "class", "ART" );
+    }
+
+    void writeMapfield( ModelWriter &writer, int parent, const Network &net ){
+      const Mapfield &mapfield = net.mapfield;
+      ListWriter l( writer, "", parent, false, net.simplified ? 10 : 11 );
+      l.integer( "id", mapfield.id );
+      l.integer( "weightDimension", mapfield.weightDimension );
+      l.integer( "capacity", mapfield.capacity );
+      l.real( "alpha", mapfield.alpha );
+      l.real( "epsilon", mapfield.epsilon );
+      l.real( "rho", mapfield.rho );
+      l.real( "beta", mapfield.beta );
+      l.integers( "change", mapfield.change );
+      if ( net.simplified ){
+        l.integers( "w", mapfield.label );
+        l.integer( "numCategories", mapfield.numCategories );
+      }
+      else{
+        l.matrix( "w", mapfield.w.data(), mapfield.rows, mapfield.cols );
+        l.integer( "numCategories_a", mapfield.numCategories_a );
+        l.integer( "numCategories_b", mapfield.numCategories_b );
+      }
+      l.close();
+    }
+
+    /* Reading */
+
+    const ModelRecord &record( const ModelFile &f, int list, const std::string &name ){
+      int index = f.element( list, name );
+      if ( index == -1 ){
+        throw std::runtime_error( "The model file has no element " + name + "." );
+      }
+      return *f.records[index];
+    }
+
+    double number( const ModelFile &f, int list, const std::string &name ){
+      int index = f.element( list, name );
+      const ModelRecord &r = record( f, list, name );
+      if ( r.length < 1 ){
+        throw std::runtime_error( "The element " + name + " of the model file is empty." );
+      }
+      if ( r.type == RECORD_DOUBLE ){
+        double x;
+        std::memcpy( &x, f.data( index ), sizeof( x ) );
+        return x;
+      }
+      if ( r.type == RECORD_INTEGER || r.type == RECORD_LOGICAL ){
+        int x;
+        std::memcpy( &x, f.data( index ), sizeof( x ) );
+        return x;
+      }
+      throw std::runtime_error( "The element " + name + " of the model file is not a number." );
+    }
+
+    std::vector< int > integers( const ModelFile &f, int index ){
+      const ModelRecord &r = *f.records[index];
+      std::vector< int > v( r.length );
+      if ( r.type == RECORD_INTEGER || r.type == RECORD_LOGICAL ){
+        std::memcpy( v.data(), f.data( index ), r.bytes );
+      }
+      else if ( r.type == RECORD_DOUBLE ){
+        const double *p = reinterpret_cast< const double * >( f.data( index ) );
+        for ( int i = 0; i < r.length; i++ ){
+          v[i] = p[i];
+        }
+      }
+      else if ( r.type != RECORD_NULL ){
+        throw std::runtime_error( "The model file is corrupt." );
+      }
+      return v;
+    }
+
+    std::vector< int > integers( const ModelFile &f, int list, const std::string &name ){
+      record( f, list, name );
+      return integers( f, f.element( list, name ) );
+    }
+
+    // matrix: the values of a numeric matrix record, and whether they are row-major. NULL if it
+    // is empty.
+    const double *matrix( const ModelFile &f, int list, const std::string &name, int &nrow, int &ncol, bool &rowMajor ){
+      const ModelRecord &r = record( f, list, name );
+      nrow = 0;
+      ncol = 0;
+      rowMajor = true;
+      if ( r.length == 0 ){
+        return NULL;
+      }
+      if ( r.type != RECORD_DOUBLE || !( r.flags & RECORD_MATRIX ) ){
+        throw std::runtime_error( "The element " + name + " of the model file is not a numeric matrix." );
+      }
+      nrow = r.nrow;
+      ncol = r.ncol;
+      rowMajor = r.flags & RECORD_ROW_MAJOR;
+      return reinterpret_cast< const double * >( f.data( f.element( list, name ) ) );
+    }
+
+    // matrix: a numeric matrix record as a row-major matrix
+    std::vector< double > matrix( const ModelFile &f, int list, const std::string &name, int &nrow, int &ncol ){
+      bool rowMajor;
+      const double *p = matrix( f, list, name, nrow, ncol, rowMajor );
+      std::vector< double > m( (size_t)nrow * ncol );
+      if ( rowMajor ){
+        std::copy( p, p + m.size(), m.begin() );
+        return m;
+      }
+      for ( int i = 0; i < nrow; i++ ){
+        for ( int j = 0; j < ncol; j++ ){
+          m[(size_t)i * ncol + j] = p[(size_t)j * nrow + i];
+        }
+      }
+      return m;
+    }
+
+    std::string stringAttribute( const ModelFile &f, int index, const std::string &name ){
+      int a = f.attribute( index, name );
+      if ( a == -1 || f.records[a]->type != RECORD_STRING || f.records[a]->length < 1 ){
+        return "";
+      }
+      return f.strings( a )[0];
+    }
+
+    // resize: the per category vectors are kept as long as the weight storage
+    void resize( std::vector< int > &v, int rows ){
+      v.resize( rows, 0 );
+    }
+
+    // readModule: the module of the list record index. With a view, its row-major weights are
+    // viewed in the mapping, which source keeps open.
+    Module readModule( const std::shared_ptr< const ModelFile > &source, int index, const Network &net, bool view ){
+      const ModelFile &f = *source;
+      Module module;
+      module.id = number( f, index, "id" );
+      module.weightDimension = number( f, index, "weightDimension" );
+      module.capacity = number( f, index, "capacity" );
+      module.numCategories = number( f, index, "numCategories" );
+      module.alpha = number( f, index, "alpha" );
+      module.epsilon = number( f, index, "epsilon" );
+      module.rho = number( f, index, "rho" );
+      module.beta = number( f, index, "beta" );
+      module.Jmax = integers( f, index, "Jmax" );
+
+      int nrow, ncol;
+      bool rowMajor;
+      const double *w = matrix( f, index, "w", nrow, ncol, rowMajor );
+      if ( view && rowMajor ){
+        module.w.setView( w, (size_t)nrow * ncol, source );
+      }
+      else{
+        module.w = matrix( f, index, "w", nrow, ncol );
+      }
+      if ( nrow > 0 && ncol != module.weightDimension ){
+        throw std::runtime_error( "The weight matrix of module " + std::to_string( module.id ) + " does not match its weight dimension." );
+      }
+      if ( nrow < module.numCategories ){
+        throw std::runtime_error( "The weight matrix of module " + std::to_string( module.id ) + " has too few rows." );
+      }
+      module.rows = nrow;
+      module.counter = integers( f, index, "counter" );
+      module.change = integers( f, index, "change" );
+      resize( module.counter, nrow );
+      resize( module.change, nrow );
+
+      if ( f.element( index, "R_bar" ) != -1 ){
+        module.R_bar = number( f, index, "R_bar" );
+        module.hasR_bar = true;
+      }
+
+      if ( net.type == NETWORK_TOPOART ){
+        module.beta1 = number( f, index, "beta1" );
+        module.beta2 = number( f, index, "beta2" );
+        module.phi = number( f, index, "phi" );
+        module.n = integers( f, index, "n" );
+        module.edges.assign( integers( f, index, "edge" ) );
+        int c = f.element( index, "linkedClusters" );
+        if ( c != -1 ){
+          for ( int e : f.elements( c ) ){
+            module.linkedClusters.push_back( integers( f, e ) );
+          }
+        }
+        if ( module.Jmax.size() < 2 ){
+          module.Jmax.resize( 2, -1 );
+        }
+      }
+      resize( module.n, nrow );
+      if ( module.Jmax.empty() ){
+        module.Jmax.push_back( -1 );
+      }
+      return module;
+    }
+
+    void readMapfield( const ModelFile &f, int index, Network &net ){
+      Mapfield &mapfield = net.mapfield;
+      mapfield.id = number( f, index, "id" );
+      mapfield.weightDimension = number( f, index, "weightDimension" );
+      mapfield.capacity = number( f, index, "capacity" );
+      mapfield.alpha = number( f, index, "alpha" );
+      mapfield.epsilon = number( f, index, "epsilon" );
+      mapfield.rho = number( f, index, "rho" );
+      mapfield.beta = number( f, index, "beta" );
+      mapfield.change = integers( f, index, "change" );
+      if ( net.simplified ){
+        mapfield.label = integers( f, index, "w" );
+        mapfield.numCategories = number( f, index, "numCategories" );
+        mapfield.change.resize( mapfield.label.size(), 0 );
+      }
+      else{
+        mapfield.w = matrix( f, index, "w", mapfield.rows, mapfield.cols );
+        mapfield.numCategories_a = number( f, index, "numCategories_a" );
+        mapfield.numCategories_b = number( f, index, "numCategories_b" );
+        mapfield.change.resize( mapfield.rows, 0 );
+      }
+    }
+  }
+
+  // saveNetwork: write the network with the layout of the R network object
+  void saveNetwork( const Network &net, const std::string &file ){
+    ModelWriter writer;
+
+    int length = 7 + ( net.type == NETWORK_TOPOART ? 1 : 0 ) + ( net.type == NETWORK_ARTMAP ? 1 : 0 );
+    ListWriter l( writer, "", -1, false, length );
+    l.integer( "numModules", net.numModules() );
+    l.integer( "dimension", net.dimension );
+    l.integer( "epochs", net.epochs );
+    l.integer( "maxEpochs", net.maxEpochs );
+    if ( net.type == NETWORK_TOPOART ){
+      l.integer( "tau", net.tau );
+      l.integer( "tauCounter", net.tauCounter );
+    }
+    else{
+      l.integer( "activeModule", -1 );
+    }
+    l.integer( "init", net.initialized ? 1 : 0 );
+
+    int modules = l.list( "module", net.numModules() );
+    for ( const Module &module : net.modules ){
+      writeModule( writer, modules, net, module );
+    }
+    if ( net.type == NETWORK_ARTMAP ){
+      std::vector< std::string > names( 1, "a" );
+      if ( !net.simplified ){
+        names.push_back( "b" );
+      }
+      writer.addOwned( RECORD_STRING, "names", modules, true, names.size(), encodeStrings( names ) );
+      l.names.push_back( "mapfield" );
+      writeMapfield( writer, l.index, net );
+    }
+    l.close();
+
+    const char *type = net.type == NETWORK_TOPOART ? "TopoART" : net.type == NETWORK_ARTMAP ? "ARTMAP" : "ART";
+    attribute( writer, l.index, "class", type );
+    if ( net.type == NETWORK_ARTMAP ){
+      int simplified = net.simplified ? 1 : 0;
+      writer.addOwned( RECORD_LOGICAL, "simplified", l.index, true, 1,
+                       std::string( reinterpret_cast< const char * >( &simplified ), sizeof( simplified ) ) );
+    }
+    attribute( writer, l.index, "rule", ruleName( net.rule ) );
+
+    writer.write( file );
+  }
+
+  // loadNetwork: read a network saved by saveNetwork or by saveModel in R. With view, the
+  // module weights stored row by row are not copied: the modules view them in the mapping, which
+  // stays open as long as they do, and copy them only when they are changed (see Weights).
+  Network loadNetwork( const std::string &file, bool view ){
+    std::shared_ptr< const ModelFile > source = std::make_shared< ModelFile >( file );
+    const ModelFile &f = *source;
+    if ( f.records[0]->type != RECORD_LIST ){
+      throw std::runtime_error( "The file " + file + " does not contain a network." );
+    }
+
+    Network net;
+    std::string type = stringAttribute( f, 0, "class" );
+    if ( type == "ART" ){
+      net.type = NETWORK_ART;
+    }
+    else if ( type == "ARTMAP" ){
+      net.type = NETWORK_ARTMAP;
+    }
+    else if ( type == "TopoART" ){
+      net.type = NETWORK_TOPOART;
+    }
+    else{
+      throw std::runtime_error( "The file " + file + " does not contain an ART, ARTMAP or TopoART network." );
+    }
+    net.rule = parseRule( stringAttribute( f, 0, "rule" ) );
+    net.dimension = number( f, 0, "dimension" );
+    net.epochs = number( f, 0, "epochs" );
+    net.maxEpochs = number( f, 0, "maxEpochs" );
+    net.initialized = number( f, 0, "init" ) != 0;
+
+    if ( net.type == NETWORK_TOPOART ){
+      net.tau = number( f, 0, "tau" );
+      net.tauCounter = f.element( 0, "tauCounter" ) != -1 ? number( f, 0, "tauCounter" ) : 0;
+    }
+    if ( net.type == NETWORK_ARTMAP ){
+      int s = f.attribute( 0, "simplified" );
+      net.simplified = s != -1 && !integers( f, s ).empty() && integers( f, s )[0] != 0;
+    }
+
+    int numModules = number( f, 0, "numModules" );
+    std::vector< int > modules = f.elements( f.element( 0, "module" ) );
+    if ( (int)modules.size() < numModules ){
+      throw std::runtime_error( "The model file has fewer modules than the network." );
+    }
+    for ( int i = 0; i < numModules; i++ ){
+      net.modules.push_back( readModule( source, modules[i], net, view ) );
+    }
+    if ( net.type == NETWORK_ARTMAP ){
+      readMapfield( f, f.element( 0, "mapfield" ), net );
+    }
+
+    return net;
+  }
+
+}
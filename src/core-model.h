@@ -0,0 +1,120 @@
+/****************************************************************************
+ *
+ *  core-model.h
+ *  Binary model files
+ *
+ ****************************************************************************/
+
+#ifndef CORE_MODEL_H
+#define CORE_MODEL_H
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include "core.h"
+#include "core-io.h"
+
+namespace core {
+
+  /* The binary model format (version 2), little-endian:
+   *
+   *   Header   64 bytes
+   *   Records  numRecords x 64 bytes, starting at tableOffset
+   *   Data     one block per vector record, each starting at a multiple of 64 bytes
+   *
+   * The network is stored as a tree of records in depth-first order: a list record is followed
+   * by its elements, and every record is followed by its attributes (class, rule, names, ...).
+   * Matrices are stored with their dimensions in the record, column-major like R, except the
+   * double matrices flagged RECORD_ROW_MAJOR (all of them since version 2), which are stored row
+   * by row like Module::w, so a loaded network can search its weights straight from the mapping
+   * (see loadNetwork). Version 1 files, all column-major, are still read. List element names
+   * are stored as the "names" attribute; attribute names are limited to 27 characters.
+   * The tree has the layout of the R network object, so the files written by R and by the rart
+   * command line tool can be read by either.
+   */
+
+  const char MODEL_MAGIC[8] = { 'r', 'A', 'R', 'T', 'b', 'i', 'n', '\0' };
+  const uint32_t MODEL_VERSION = 2;
+  const uint32_t MODEL_BYTE_ORDER = 0x01020304;
+  const int MODEL_ALIGNMENT = 64;
+
+  enum ModelRecordType {
+    RECORD_NULL = 0,
+    RECORD_LIST = 1,
+    RECORD_INTEGER = 2,
+    RECORD_DOUBLE = 3,
+    RECORD_LOGICAL = 4,
+    RECORD_STRING = 5     // NUL terminated strings, NA is stored as a single 0xFF byte
+  };
+
+  enum ModelRecordFlag {
+    RECORD_ATTRIBUTE = 1, // the record is an attribute of its parent, named by name
+    RECORD_MATRIX = 2,    // the record has the dimension nrow x ncol
+    RECORD_ROW_MAJOR = 4  // the matrix is stored row by row
+  };
+
+  struct ModelHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t byteOrder;
+    uint32_t numRecords;
+    uint32_t reserved;
+    uint64_t tableOffset;
+    uint64_t fileSize;
+    char padding[24];
+  };
+
+  struct ModelRecord {
+    char name[28];
+    int32_t parent;     // index of the parent record, -1 for the network itself
+    uint8_t type;
+    uint8_t flags;
+    uint16_t reserved;
+    int32_t length;     // the number of elements
+    int32_t nrow;       // the dimension of a matrix
+    int32_t ncol;
+    uint64_t offset;    // start of the data block
+    uint64_t bytes;     // size of the data block
+  };
+
+  bool isLittleEndian();
+
+  /* ModelWriter: collects the records of a model file in depth-first order and writes them.
+     The data of a record is either borrowed (it must outlive write) or owned by the writer. */
+  struct ModelWriter {
+    std::vector< ModelRecord > records;
+
+    int add( int type, const std::string &name, int parent, bool attribute, int length,
+             const void *data = NULL, size_t bytes = 0 );
+    int addOwned( int type, const std::string &name, int parent, bool attribute, int length, const std::string &data );
+    void setMatrix( int index, int nrow, int ncol, bool rowMajor = false );
+    void write( const std::string &file );
+
+  private:
+    std::vector< const char * > borrowed;
+    std::vector< std::string > owned;
+  };
+
+  /* ModelFile: a model file mapped into memory. The header and all records are checked when
+     the file is opened; the data blocks are read straight from the mapping. */
+  struct ModelFile {
+    MappedFile file;
+    const ModelHeader *header;
+    std::vector< const ModelRecord * > records;
+    std::vector< std::vector< int > > children;
+
+    explicit ModelFile( const std::string &path );
+    const char *data( int index ) const { return file.data + records[index]->offset; }
+    bool isAttribute( int index ) const { return records[index]->flags & RECORD_ATTRIBUTE; }
+    std::vector< std::string > strings( int index ) const;
+    int attribute( int index, const std::string &name ) const;
+    int element( int list, const std::string &name ) const;
+    std::vector< int > elements( int list ) const;
+  };
+
+  void saveNetwork( const Network &net, const std::string &file );
+  Network loadNetwork( const std::string &file, bool view = true );
+
+}
+
+#endif
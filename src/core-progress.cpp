@@ -0,0 +1,49 @@
+/****************************************************************************
+ *
+ *  core-progress.cpp
+ *  Progress of training
+ *
+ ****************************************************************************/
+
+#include <stdexcept>
+#include "core-progress.h"
+
+namespace core {
+
+  // writeArray: a JSON array of integers
+  static void writeArray( std::ostream &out, const std::vector< int > &x ){
+    out << "[";
+    for ( size_t i = 0; i < x.size(); i++ ){
+      out << ( i > 0 ? "," : "" ) << x[i];
+    }
+    out << "]";
+  }
+
+  JSONLinesSink::JSONLinesSink( const std::string &file, double interval )
+    : ProgressSink( interval ), file( file ), out( file.c_str(), std::ios::app ) {
+    if ( !out ){
+      throw std::runtime_error( "Can't open the file " + file + " for writing." );
+    }
+    out.precision( 6 );
+  }
+
+  // report: one line per report. The line is flushed, as the reports are rate-limited.
+  void JSONLinesSink::report( const Progress &p ){
+    out << "{\"epoch\":" << p.epoch << ",\"maxEpochs\":" << p.maxEpochs << ",\"changes\":" << p.changes
+        << ",\"moduleChanges\":";
+    writeArray( out, p.moduleChanges );
+    out << ",\"categories\":";
+    writeArray( out, p.categories );
+    out << ",\"rows\":" << p.rows << ",\"elapsed\":" << p.elapsed << ",\"rowsPerSecond\":" << p.rowsPerSecond
+        << ",\"done\":" << ( p.done ? "true" : "false" );
+    if ( p.done ){
+      out << ",\"stopReason\":\"" << stopReasonName( p.stopReason ) << "\"";
+    }
+    out << "}\n";
+    out.flush();
+    if ( !out ){
+      throw std::runtime_error( "Failed to write the file " + file + "." );
+    }
+  }
+
+}
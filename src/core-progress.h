@@ -0,0 +1,37 @@
+/****************************************************************************
+ *
+ *  core-progress.h
+ *  Progress of training
+ *
+ *  Sinks for the epochs reported by train through Network::progress.
+ *  Training is silent unless a sink is set.
+ *
+ ****************************************************************************/
+
+#ifndef CORE_PROGRESS_H
+#define CORE_PROGRESS_H
+
+#include <fstream>
+#include <string>
+#include "core.h"
+
+namespace core {
+
+  /* JSONLinesSink: appends each report to a file as one JSON object per line, e.g.
+     {"epoch":2,"maxEpochs":10,"changes":3,"moduleChanges":[0,3],"categories":[3,5],"rows":180,
+      "elapsed":0.0021,"rowsPerSecond":85714,"done":false}. The last one also has the stopReason.  */
+  class JSONLinesSink : public ProgressSink {
+  public:
+    JSONLinesSink( const std::string &file, double interval = 0 );
+
+  protected:
+    void report( const Progress &p );
+
+  private:
+    std::string file;
+    std::ofstream out;
+  };
+
+}
+
+#endif
@@ -0,0 +1,759 @@
+/****************************************************************************
+ *
+ *  core-rules.cpp
+ *  The fuzzy, hypersphere and ART1 learning rules
+ *
+ *  The activation and match functions skip the missing (NaN) values like
+ *  na_omit did, while the weight updates propagate them. They are templates
+ *  on the number of values N, 0 for any number n: the modules of up to 16
+ *  features use the instances for their size, which the compiler unrolls
+ *  (see kernels).
+ *
+ *
+ *
+ *  References:
+ *  1. Carpenter, GA, Grossberg, S, Rosen DB. (1991) "Fuzzy ART: Fast stable
+ *  learning and categorization of analog patterns by an adaptive resonance
+ *  system", Neural Networks, 4(6), pp 759-771.
+ *  2. Anagnostopoulos, GC, Georgiopoulos, M. (2000) "Hypersphere ART and ARTMAP
+ *  Unsupervised and Supervised, Incremental Learning", Proceedings of the
+ *  IEEE-INNS-ENNS International Joint Conference on Neural Networks. Neural
+ *  Computing: New Challenges and Perspectives for the New Millennium, 6.
+ *  3. da Silva, L.E.B, Elnabarawy, I., and Wunsch II, D.C. (2019) "A survey of
+ *  Adaptive Resonance Theory neural network models for engineering applications",
+ *  Neural Networks, 120, pp 167 - 203.
+ *
+ ****************************************************************************/
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include "core.h"
+
+namespace core {
+
+  namespace {
+
+    const double NA = std::numeric_limits< double >::quiet_NaN();
+
+    // pmin: the minimum of two values, NaN if either is missing
+    inline double pmin( double x, double w ){
+      if ( std::isnan( x ) || std::isnan( w ) ){
+        return NA;
+      }
+      return x < w ? x : w;
+    }
+
+    // the minimum and maximum of two values, ignoring a missing value
+    inline double minOmit( double a, double b ){
+      if ( std::isnan( a ) ) return b;
+      if ( std::isnan( b ) ) return a;
+      return a < b ? a : b;
+    }
+
+    inline double maxOmit( double a, double b ){
+      if ( std::isnan( a ) ) return b;
+      if ( std::isnan( b ) ) return a;
+      return a > b ? a : b;
+    }
+  }
+
+  namespace fuzzy {
+
+    // The sums of the kernels add 0 for a missing value rather than branch. The sums start at +0,
+    // so the results are the same.
+
+    template< int N > double activationN( const double *x, const double *w, int n, double alpha ){
+      n = N > 0 ? N : n;
+      double s = 0;
+      double sw = 0;
+      for ( int i = 0; i < n; i++ ){
+        bool omit = std::isnan( x[i] ) || std::isnan( w[i] );
+        s += omit ? 0.0 : ( x[i] < w[i] ? x[i] : w[i] );
+        sw += std::isnan( w[i] ) ? 0.0 : w[i];
+      }
+      return s/( alpha + sw );
+    }
+
+    double activation( const double *x, const double *w, int n, double alpha ){
+      return activationN< 0 >( x, w, n, alpha );
+    }
+
+    // blockActivation: activation for the categories of a block (see CategoryBlocks), summed in the
+    // same order so the results are the same
+    template< int N > void blockActivationN( const double *x, const double *block, int n, double alpha, double *a ){
+      n = N > 0 ? N : n;
+      const int L = CategoryBlocks::LANES;
+      double s[L] = {};
+      double sw[L] = {};
+      for ( int i = 0; i < n; i++ ){
+        const double *w = block + i * L;
+        double xi = x[i];
+        bool missing = std::isnan( xi );
+        for ( int l = 0; l < L; l++ ){
+          bool omit = missing || std::isnan( w[l] );
+          s[l] += omit ? 0.0 : ( xi < w[l] ? xi : w[l] );
+          sw[l] += std::isnan( w[l] ) ? 0.0 : w[l];
+        }
+      }
+      for ( int l = 0; l < L; l++ ){
+        a[l] = s[l]/( alpha + sw[l] );
+      }
+    }
+
+    void blockActivation( const double *x, const double *block, int n, double alpha, double *a ){
+      blockActivationN< 0 >( x, block, n, alpha, a );
+    }
+
+    template< int N > double matchN( const double *x, const double *w, int n ){
+      n = N > 0 ? N : n;
+      double s = 0;
+      double sx = 0;
+      for ( int i = 0; i < n; i++ ){
+        bool omit = std::isnan( x[i] ) || std::isnan( w[i] );
+        s += omit ? 0.0 : ( x[i] < w[i] ? x[i] : w[i] );
+        sx += std::isnan( x[i] ) ? 0.0 : x[i];
+      }
+      return s/sx;
+    }
+
+    double match( const double *x, const double *w, int n ){
+      return matchN< 0 >( x, w, n );
+    }
+
+    // earlyMatch: match with the norm sx of x, dropping the category (-Inf) at the end of the first
+    // block where the sum so far and the positive values of x left (rest) are below need. No term
+    // left adds more than the value of x it is taken from.
+    double earlyMatch( const double *x, const double *w, int n, double sx, const double *rest, double need ){
+      const int B = Vigilance::BLOCK;
+      double s = 0;
+      for ( int b = 0; b < n; b += B ){
+        int e = std::min( b + B, n );
+        for ( int i = b; i < e; i++ ){
+          bool omit = std::isnan( x[i] ) || std::isnan( w[i] );
+          s += omit ? 0.0 : ( x[i] < w[i] ? x[i] : w[i] );
+        }
+        if ( s + rest[b/B + 1] < need ){
+          return -std::numeric_limits< double >::infinity();
+        }
+      }
+      return s/sx;
+    }
+
+    // categoryMatch: the match of the box merging the categories v and w. It is the match of a
+    // complement coded row, whose norm is n/2, so the merged box is held to the same size as the
+    // boxes learned from rows.
+    double categoryMatch( const double *v, const double *w, int n ){
+      double s = 0;
+      for ( int i = 0; i < n; i++ ){
+        double m = pmin( v[i], w[i] );
+        if ( !std::isnan( m ) ) s += m;
+      }
+      return s/( n/2 );
+    }
+
+    // weightUpdate: update w in place and return the sum of the absolute changes
+    double weightUpdate( const double *x, double *w, int n, double learningRate ){
+      double change = 0;
+      for ( int i = 0; i < n; i++ ){
+        double w_new = learningRate * pmin( x[i], w[i] ) + ( 1.0 - learningRate ) * w[i];
+        change += std::fabs( w[i] - w_new );
+        w[i] = w_new;
+      }
+      return change;
+    }
+  }
+
+  namespace hypersphere {
+
+    // The weight is the centre m of the hypersphere (n values) followed by its radius R.
+
+    template< int N > double normN( const double *x, const double *m, int n ){
+      n = N > 0 ? N : n;
+      double s = 0;
+      for ( int i = 0; i < n; i++ ){
+        double d = x[i] - m[i];
+        s += std::isnan( d ) ? 0.0 : d * d;
+      }
+      return std::sqrt( s );
+    }
+
+    double norm( const double *x, const double *m, int n ){
+      return normN< 0 >( x, m, n );
+    }
+
+    template< int N > double activationN( const double *x, const double *w, int n, double R_bar, double alpha ){
+      n = N > 0 ? N : n;
+      double R = w[n];
+      double maximum = maxOmit( R, normN< N >( x, w, n ) );
+      return ( R_bar - maximum )/( R_bar - R + alpha );
+    }
+
+    double activation( const double *x, const double *w, int n, double R_bar, double alpha ){
+      return activationN< 0 >( x, w, n, R_bar, alpha );
+    }
+
+    // blockActivation: activation for the categories of a block (see CategoryBlocks)
+    template< int N > void blockActivationN( const double *x, const double *block, int n, double R_bar, double alpha, double *a ){
+      n = N > 0 ? N : n;
+      const int L = CategoryBlocks::LANES;
+      double s[L] = {};
+      for ( int i = 0; i < n; i++ ){
+        const double *m = block + i * L;
+        for ( int l = 0; l < L; l++ ){
+          double d = x[i] - m[l];
+          s[l] += std::isnan( d ) ? 0.0 : d * d;
+        }
+      }
+      const double *R = block + n * L;
+      for ( int l = 0; l < L; l++ ){
+        double maximum = maxOmit( R[l], std::sqrt( s[l] ) );
+        a[l] = ( R_bar - maximum )/( R_bar - R[l] + alpha );
+      }
+    }
+
+    void blockActivation( const double *x, const double *block, int n, double R_bar, double alpha, double *a ){
+      blockActivationN< 0 >( x, block, n, R_bar, alpha, a );
+    }
+
+    template< int N > double matchN( const double *x, const double *w, int n, double R_bar ){
+      n = N > 0 ? N : n;
+      double R = w[n];
+      double maximum = maxOmit( R, normN< N >( x, w, n ) );
+      return 1 - maximum/R_bar;
+    }
+
+    double match( const double *x, const double *w, int n, double R_bar ){
+      return matchN< 0 >( x, w, n, R_bar );
+    }
+
+    // earlyMatch: match, dropping the category (-Inf) at the end of the first block where the
+    // squared distance so far is above limit2. The distance only grows with the values left.
+    double earlyMatch( const double *x, const double *w, int n, double R_bar, double limit2 ){
+      const int B = Vigilance::BLOCK;
+      double s = 0;
+      for ( int b = 0; b < n; b += B ){
+        int e = std::min( b + B, n );
+        for ( int i = b; i < e; i++ ){
+          double d = x[i] - w[i];
+          s += std::isnan( d ) ? 0.0 : d * d;
+        }
+        if ( s > limit2 ){
+          return -std::numeric_limits< double >::infinity();
+        }
+      }
+      double maximum = maxOmit( w[n], std::sqrt( s ) );
+      return 1 - maximum/R_bar;
+    }
+
+    // categoryMatch: the match of the hypersphere enclosing the hyperspheres v and w
+    double categoryMatch( const double *v, const double *w, int n, double R_bar ){
+      double maximum = maxOmit( w[n], norm( v, w, n ) + v[n] );
+      return 1 - maximum/R_bar;
+    }
+
+    double weightUpdate( const double *x, double *w, int n, double learningRate ){
+      double R = w[n];
+      double dis = norm( x, w, n );
+      double change = 0;
+      if ( !( dis < 0.000001 ) ){
+        double minimum = minOmit( R, dis );
+        for ( int i = 0; i < n; i++ ){
+          double m_new = w[i] + learningRate/2 * ( x[i] - w[i] ) * ( 1 - minimum/dis );
+          change += std::fabs( w[i] - m_new );
+          w[i] = m_new;
+        }
+      }
+      double R_new = R + learningRate/2 * ( maxOmit( R, dis ) - R );
+      change += std::fabs( R - R_new );
+      w[n] = R_new;
+      return change;
+    }
+
+    // categoryUpdate: weightUpdate for the hypersphere v instead of a point. Its far side, at
+    // dis + v[n] from the centre of w, is learned like a row there, so with learning rate 1 w
+    // becomes the hypersphere enclosing both (see categoryMatch).
+    double categoryUpdate( const double *v, double *w, int n, double learningRate ){
+      double R = w[n];
+      double dis = norm( v, w, n );
+      double far = dis + v[n];
+      double change = 0;
+      if ( !( dis < 0.000001 ) ){
+        double minimum = minOmit( R, far );
+        for ( int i = 0; i < n; i++ ){
+          double m_new = w[i] + learningRate/2 * ( v[i] - w[i] ) * ( far - minimum )/dis;
+          change += std::fabs( w[i] - m_new );
+          w[i] = m_new;
+        }
+      }
+      double R_new = R + learningRate/2 * ( maxOmit( R, far ) - R );
+      change += std::fabs( R - R_new );
+      w[n] = R_new;
+      return change;
+    }
+
+    // R_bar: the radius of the data, estimated from the range of each column
+    double R_bar( const std::vector< double > &minimum, const std::vector< double > &maximum ){
+      double s = 0;
+      int n = minimum.size();
+      for ( int i = 0; i < n; i++ ){
+        double d = maximum[i] - minimum[i];
+        if ( !std::isnan( d ) ) s += d * d;
+      }
+      return std::sqrt( 0.5 * s );
+    }
+  }
+
+  namespace art1 {
+
+    // The weight is the bottom-up weight w_bu (n values) followed by the top-down weight w_td.
+
+    void newWeight( int n, double L, double *w ){
+      double w_bu = L/( L - 1 + n );
+      for ( int i = 0; i < n; i++ ){
+        w[i] = w_bu;
+        w[i+n] = 1.0;
+      }
+    }
+
+    template< int N > double activationN( const double *x, const double *w, int n ){
+      n = N > 0 ? N : n;
+      double T = 0;
+      for ( int i = 0; i < n; i++ ){
+        T += std::isnan( x[i] ) ? 0.0 : x[i] * w[i];
+      }
+      return T;
+    }
+
+    double activation( const double *x, const double *w, int n ){
+      return activationN< 0 >( x, w, n );
+    }
+
+    // blockActivation: activation for the categories of a block (see CategoryBlocks)
+    template< int N > void blockActivationN( const double *x, const double *block, int n, double *a ){
+      n = N > 0 ? N : n;
+      const int L = CategoryBlocks::LANES;
+      double T[L] = {};
+      for ( int i = 0; i < n; i++ ){
+        if ( std::isnan( x[i] ) ){
+          continue;
+        }
+        const double *w = block + i * L;
+        for ( int l = 0; l < L; l++ ){
+          T[l] += x[i] * w[l];
+        }
+      }
+      for ( int l = 0; l < L; l++ ){
+        a[l] = T[l];
+      }
+    }
+
+    void blockActivation( const double *x, const double *block, int n, double *a ){
+      blockActivationN< 0 >( x, block, n, a );
+    }
+
+    template< int N > double matchN( const double *x, const double *w, int n ){
+      n = N > 0 ? N : n;
+      double s = 0;
+      double sx = 0;
+      for ( int i = 0; i < n; i++ ){
+        double m = x[i] * w[i+n];
+        s += std::isnan( m ) ? 0.0 : m;
+        sx += std::isnan( x[i] ) ? 0.0 : x[i];
+      }
+      return s/sx;
+    }
+
+    double match( const double *x, const double *w, int n ){
+      return matchN< 0 >( x, w, n );
+    }
+
+    // earlyMatch: see fuzzy::earlyMatch, the top-down weights being 0 or 1
+    double earlyMatch( const double *x, const double *w, int n, double sx, const double *rest, double need ){
+      const int B = Vigilance::BLOCK;
+      double s = 0;
+      for ( int b = 0; b < n; b += B ){
+        int e = std::min( b + B, n );
+        for ( int i = b; i < e; i++ ){
+          double m = x[i] * w[i+n];
+          s += std::isnan( m ) ? 0.0 : m;
+        }
+        if ( s + rest[b/B + 1] < need ){
+          return -std::numeric_limits< double >::infinity();
+        }
+      }
+      return s/sx;
+    }
+
+    // weightUpdate: w_td is intersected with x and w_bu is recomputed from the new w_td with
+    // the module's learning parameter L
+    double weightUpdate( const double *x, double *w, int n, double L ){
+      double change = 0;
+      double s = 0;
+      for ( int i = 0; i < n; i++ ){
+        double w_td = x[i] * w[i+n];
+        change += std::fabs( w[i+n] - w_td );
+        w[i+n] = w_td;
+        s += w_td;
+      }
+      double scale = L/( L - 1 + s );
+      for ( int i = 0; i < n; i++ ){
+        double w_bu = scale * w[i+n];
+        change += std::fabs( w[i] - w_bu );
+        w[i] = w_bu;
+      }
+      return change;
+    }
+  }
+
+  std::string ruleName( Rule rule ){
+    switch ( rule ){
+      case RULE_FUZZY: return "fuzzy";
+      case RULE_HYPERSPHERE: return "hypersphere";
+      case RULE_ART1: return "ART1";
+    }
+    return "";
+  }
+
+  Rule parseRule( const std::string &name ){
+    if ( name == "fuzzy" ) return RULE_FUZZY;
+    if ( name == "hypersphere" ) return RULE_HYPERSPHERE;
+    if ( name == "ART1" ) return RULE_ART1;
+    throw std::invalid_argument( "Unknown rule " + name + "." );
+  }
+
+  // weightDimension: the total dimension of the weight vector
+  int weightDimension( Rule rule, int dimension ){
+    return rule == RULE_HYPERSPHERE ? dimension + 1 : dimension * 2;
+  }
+
+  // codeDimension: the dimension of the processed input code
+  int codeDimension( Rule rule, int dimension ){
+    return rule == RULE_FUZZY ? dimension * 2 : dimension;
+  }
+
+  // processCode: the processing of the input specific to the rule, i.e. the complement code
+  // for the fuzzy rule
+  void processCode( Rule rule, const double *x, int dimension, double *code ){
+    for ( int i = 0; i < dimension; i++ ){
+      code[i] = x[i];
+    }
+    if ( rule == RULE_FUZZY ){
+      for ( int i = 0; i < dimension; i++ ){
+        code[i+dimension] = 1 - x[i];
+      }
+    }
+  }
+
+  // unProcessCode: revert the processed code to the original input. Returns its length.
+  int unProcessCode( Rule rule, const double *code, int length, double *x ){
+    if ( rule == RULE_FUZZY ){
+      if ( length % 2 != 0 ){
+        throw std::invalid_argument( "The length of the code must be an even number." );
+      }
+      length /= 2;
+    }
+    for ( int i = 0; i < length; i++ ){
+      x[i] = code[i];
+    }
+    return length;
+  }
+
+  // The input of a module is the processed code, or the weight of the resonating category of the
+  // module below. Only its first n values are read, so the radius of a hypersphere weight is
+  // stripped from the input of the next module.
+
+  void newWeight( Rule rule, const Module &module, const double *x, double *w ){
+    int d = module.weightDimension;
+    switch ( rule ){
+      case RULE_FUZZY:
+        for ( int i = 0; i < d; i++ ) w[i] = x[i];
+        break;
+      case RULE_HYPERSPHERE:
+        for ( int i = 0; i < d - 1; i++ ) w[i] = x[i];
+        w[d-1] = 0;   // the radius
+        break;
+      case RULE_ART1:
+        art1::newWeight( d/2, module.beta, w );
+        break;
+    }
+  }
+
+  // categoryWeight: the weight of a new category that stands for the category v of another module
+  // (see categoryInput). A hypersphere keeps the radius of v; the other rules start as newWeight.
+  void categoryWeight( Rule rule, const Module &module, const double *v, double *w ){
+    if ( rule == RULE_HYPERSPHERE ){
+      std::copy( v, v + module.weightDimension, w );
+    }
+    else{
+      newWeight( rule, module, v, w );
+    }
+  }
+
+  double activation( Rule rule, const Module &module, const double *x, const double *w ){
+    return kernels( rule, module.weightDimension ).activation( module, x, w );
+  }
+
+  namespace {
+
+    // the kernels of each rule for modules of D features, or any number if D is 0
+    template< int D > struct FuzzyKernels {
+      static double activation( const Module &module, const double *x, const double *w ){
+        return fuzzy::activationN< 2 * D >( x, w, module.weightDimension, module.alpha );
+      }
+      static double match( const Module &module, const double *x, const double *w ){
+        return fuzzy::matchN< 2 * D >( x, w, module.weightDimension );
+      }
+      static void blockActivation( const Module &module, const double *x, const double *block, double *a ){
+        fuzzy::blockActivationN< 2 * D >( x, block, module.weightDimension, module.alpha, a );
+      }
+    };
+
+    template< int D > struct HypersphereKernels {
+      static double activation( const Module &module, const double *x, const double *w ){
+        return hypersphere::activationN< D >( x, w, module.weightDimension - 1, module.R_bar, module.alpha );
+      }
+      static double match( const Module &module, const double *x, const double *w ){
+        return hypersphere::matchN< D >( x, w, module.weightDimension - 1, module.R_bar );
+      }
+      static void blockActivation( const Module &module, const double *x, const double *block, double *a ){
+        hypersphere::blockActivationN< D >( x, block, module.weightDimension - 1, module.R_bar, module.alpha, a );
+      }
+    };
+
+    template< int D > struct ART1Kernels {
+      static double activation( const Module &module, const double *x, const double *w ){
+        return art1::activationN< D >( x, w, module.weightDimension/2 );
+      }
+      static double match( const Module &module, const double *x, const double *w ){
+        return art1::matchN< D >( x, w, module.weightDimension/2 );
+      }
+      static void blockActivation( const Module &module, const double *x, const double *block, double *a ){
+        art1::blockActivationN< D >( x, block, module.weightDimension/2, a );
+      }
+    };
+
+    const int MAX_FIXED = 16;
+
+    // fill: the kernels for 0, ..., D features
+    template< template< int > class K, int D > struct Fill {
+      static void fill( Kernels *k ){
+        Fill< K, D - 1 >::fill( k );
+        Kernels f = { &K< D >::activation, &K< D >::match, &K< D >::blockActivation };
+        k[D] = f;
+      }
+    };
+
+    template< template< int > class K > struct Fill< K, -1 > {
+      static void fill( Kernels * ) {}
+    };
+
+    struct KernelTable {
+      Kernels rules[3][MAX_FIXED + 1];
+
+      KernelTable() {
+        Fill< FuzzyKernels, MAX_FIXED >::fill( rules[RULE_FUZZY] );
+        Fill< HypersphereKernels, MAX_FIXED >::fill( rules[RULE_HYPERSPHERE] );
+        Fill< ART1Kernels, MAX_FIXED >::fill( rules[RULE_ART1] );
+      }
+    };
+
+    const KernelTable table;
+  }
+
+  // kernels: the kernels of a rule for the weight dimension, unrolled for up to MAX_FIXED features.
+  // The loops over the categories look them up once.
+  const Kernels &kernels( Rule rule, int weightDimension ){
+    int features = rule == RULE_HYPERSPHERE ? weightDimension - 1 : weightDimension/2;
+    return table.rules[rule][features >= 1 && features <= MAX_FIXED ? features : 0];
+  }
+
+  // blockActivation: the activations of the categories of a block of the module (see CategoryBlocks)
+  void blockActivation( Rule rule, const Module &module, const double *x, const double *block, double *a ){
+    kernels( rule, module.weightDimension ).blockActivation( module, x, block, a );
+  }
+
+  double match( Rule rule, const Module &module, const double *x, const double *w ){
+    return kernels( rule, module.weightDimension ).match( module, x, w );
+  }
+
+  // blockBound: upper bounds on the activation T and the match m of the categories of block b of
+  // the envelopes of the module, for the input x of norm sx (fuzzy and ART1). They are Inf for
+  // the blocks that cannot be bounded, and are raised by a margin for the rounding of the sums.
+  //   fuzzy: |x ^ w| <= U, the sum of min( x, hi ), and |w| >= max( |x ^ w|, L ), L the sum of lo,
+  //          for inputs and weights of at least 0, so T <= U/( alpha + max( U, L ) ) and m <= U/|x|
+  //   hypersphere: the distance to a centre is at least the distance to the centre of the ball
+  //          less its radius, and T is largest at the ends of the range of the radii or at that
+  //          distance
+  //   ART1: the sums of x times the largest weights, for inputs and weights of at least 0
+  void blockBound( Rule rule, const Module &module, const double *x, double sx, int b, double &T, double &m ){
+    const CategoryEnvelopes &e = module.envelopes;
+    const double inf = std::numeric_limits< double >::infinity();
+    const double eps = std::numeric_limits< double >::epsilon();
+    int d = module.weightDimension;
+    const double *hi = &e.hi[(size_t)b * d];
+    const double *lo = &e.lo[(size_t)b * d];
+    T = inf;
+    m = inf;
+    if ( !e.bounded[b] ){
+      return;
+    }
+    switch ( rule ){
+      case RULE_FUZZY: {
+        if ( !( module.alpha > 0 ) || !( sx > 0 ) ){
+          return;
+        }
+        double U = 0;
+        double L = 0;
+        for ( int i = 0; i < d; i++ ){
+          if ( lo[i] < 0 || x[i] < 0 ){
+            return;
+          }
+          U += std::isnan( x[i] ) ? 0.0 : ( x[i] < hi[i] ? x[i] : hi[i] );
+          L += lo[i];
+        }
+        double margin = 4 * ( d + 4 ) * eps;
+        T = U/( module.alpha + std::max( U, L ) ) + margin;
+        m = U/sx * ( 1 + margin ) + margin;
+        break;
+      }
+      case RULE_HYPERSPHERE: {
+        int n = d - 1;
+        double R_bar = module.R_bar;
+        double R_min = lo[n];
+        double R_max = hi[n];
+        double denominator = R_bar - R_max + module.alpha;
+        double centre = hypersphere::norm( x, &e.centre[(size_t)b * d], n );
+        if ( !( R_bar > 0 ) || std::isinf( R_bar ) || !( denominator > 0 ) || !std::isfinite( centre ) ){
+          return;
+        }
+        double distance = std::max( 0.0, centre - e.radius[b] );
+        double R[] = { R_min, R_max, std::min( std::max( distance, R_min ), R_max ) };
+        T = -inf;
+        for ( double r : R ){
+          T = std::max( T, ( R_bar - std::max( r, distance ) )/( R_bar - r + module.alpha ) );
+        }
+        m = 1 - std::max( R_min, distance )/R_bar;
+        double margin = 8 * ( n + 4 ) * eps;
+        double scale = R_bar + R_max + centre + e.radius[b];
+        T += margin * ( 1 + std::fabs( T ) + scale/denominator );
+        m += margin * ( 1 + scale/R_bar );
+        break;
+      }
+      case RULE_ART1: {
+        int n = d/2;
+        if ( !( sx > 0 ) ){
+          return;
+        }
+        double s = 0;
+        double t = 0;
+        for ( int i = 0; i < n; i++ ){
+          if ( lo[i] < 0 || lo[i+n] < 0 || x[i] < 0 ){
+            return;
+          }
+          if ( !std::isnan( x[i] ) ){
+            s += x[i] * hi[i];
+            t += x[i] * hi[i+n];
+          }
+        }
+        double margin = 4 * ( n + 4 ) * eps;
+        T = s * ( 1 + margin ) + margin;
+        m = t/sx * ( 1 + margin ) + margin;
+        break;
+      }
+    }
+  }
+
+  // The vigilance test of a wide input stops at the end of the first block of values after which
+  // the category provably fails, so most of the rejected categories of a search are dropped after a
+  // fraction of the values. The categories kept are matched with the same sums in the same order as
+  // match, and the bounds have a margin for the rounding of the sums, so the searches pick the same
+  // categories.
+
+  Vigilance::Vigilance( Rule rule, const Module &module, const double *x )
+    : rule( rule ), module( module ), x( x ), f( kernels( rule, module.weightDimension ) ),
+      n( rule == RULE_FUZZY ? module.weightDimension :
+         rule == RULE_HYPERSPHERE ? module.weightDimension - 1 : module.weightDimension/2 ),
+      early( false ), sx( 0 ), sizeX( 0 ) {
+    int features = rule == RULE_FUZZY ? n/2 : n;
+    early = features > MAX_FIXED;
+    if ( !early || rule == RULE_HYPERSPHERE ){
+      return;
+    }
+    for ( int i = 0; i < n; i++ ){
+      sx += std::isnan( x[i] ) ? 0.0 : x[i];
+      sizeX += std::isnan( x[i] ) ? 0.0 : std::fabs( x[i] );
+    }
+    int blocks = ( n + BLOCK - 1 )/BLOCK;
+    rest.assign( blocks + 1, 0 );
+    for ( int b = blocks - 1; b >= 0; b-- ){
+      double s = 0;
+      for ( int i = b * BLOCK; i < std::min( ( b + 1 ) * BLOCK, n ); i++ ){
+        s += x[i] > 0 ? x[i] : 0.0;
+      }
+      rest[b] = rest[b + 1] + s;
+    }
+  }
+
+  double Vigilance::match( const double *w, double rho ) const {
+    if ( !early ){
+      return f.match( module, x, w );
+    }
+    const double eps = std::numeric_limits< double >::epsilon();
+    switch ( rule ){
+      case RULE_FUZZY:
+      case RULE_ART1: {
+        double need = rho * sx - 4 * ( n + 2 ) * eps * ( sizeX + std::fabs( rho * sx ) );
+        return rule == RULE_FUZZY ? fuzzy::earlyMatch( x, w, n, sx, rest.data(), need )
+                                  : art1::earlyMatch( x, w, n, sx, rest.data(), need );
+      }
+      case RULE_HYPERSPHERE: {
+        // the distance above which 1 - distance/R_bar is below rho
+        double limit = ( ( 1 - rho ) * ( 1 + 8 * eps ) + 8 * eps ) * module.R_bar * ( 1 + 4 * ( n + 2 ) * eps );
+        if ( !( limit >= 0 ) || std::isinf( limit ) ){
+          return f.match( module, x, w );
+        }
+        return hypersphere::earlyMatch( x, w, n, module.R_bar, limit * limit );
+      }
+    }
+    return f.match( module, x, w );
+  }
+
+  // categoryInput: the input that stands for the category with weight w of a module when it is
+  // learned by another module of the same rule, the top-down weights for ART1
+  const double *categoryInput( Rule rule, const Module &module, const double *w ){
+    return rule == RULE_ART1 ? w + module.weightDimension/2 : w;
+  }
+
+  // categoryMatch: the match of category w for the input v of another category (see
+  // categoryInput), judged on the category merging both so it is held to the vigilance of rows
+  double categoryMatch( Rule rule, const Module &module, const double *v, const double *w ){
+    switch ( rule ){
+      case RULE_FUZZY: return fuzzy::categoryMatch( v, w, module.weightDimension );
+      case RULE_HYPERSPHERE: return hypersphere::categoryMatch( v, w, module.weightDimension - 1, module.R_bar );
+      case RULE_ART1: return art1::match( v, w, module.weightDimension/2 );
+    }
+    return 0;
+  }
+
+  // weightUpdate: update the weight w in place. Returns the sum of the absolute changes.
+  double weightUpdate( Rule rule, const Module &module, double learningRate, const double *x, double *w ){
+    switch ( rule ){
+      case RULE_FUZZY: return fuzzy::weightUpdate( x, w, module.weightDimension, learningRate );
+      case RULE_HYPERSPHERE: return hypersphere::weightUpdate( x, w, module.weightDimension - 1, learningRate );
+      case RULE_ART1: return art1::weightUpdate( x, w, module.weightDimension/2, module.beta );
+    }
+    return 0;
+  }
+
+  // categoryUpdate: weightUpdate for the input v of another category (see categoryInput), so the
+  // category learns all of v, not only the centre of a hypersphere
+  double categoryUpdate( Rule rule, const Module &module, double learningRate, const double *v, double *w ){
+    if ( rule == RULE_HYPERSPHERE ){
+      return hypersphere::categoryUpdate( v, w, module.weightDimension - 1, learningRate );
+    }
+    return weightUpdate( rule, module, learningRate, v, w );
+  }
+
+}
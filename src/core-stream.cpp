@@ -0,0 +1,136 @@
+/****************************************************************************
+ *
+ *  core-stream.cpp
+ *  Out-of-core training data
+ *
+ ****************************************************************************/
+
+#include <stdexcept>
+#include "core-stream.h"
+
+namespace core {
+
+  FileStream::FileStream( const std::string &file, int chunkRows, int targetCols ) :
+    reader( openRows( file ) ), chunkRows( chunkRows ), targetCols( targetCols ), current( NULL ), end( false ), stopping( false ){
+    if ( chunkRows < 1 ){
+      throw std::invalid_argument( "The chunk size must be at least 1." );
+    }
+    if ( targetCols < 0 || reader->cols() <= targetCols ){
+      throw std::invalid_argument( "The file " + file + " has too few columns." );
+    }
+    start();
+  }
+
+  FileStream::~FileStream(){
+    stop();
+  }
+
+  void FileStream::start(){
+    idle.clear();
+    ready.clear();
+    for ( Buffer &b : buffers ){
+      idle.push_back( &b );
+    }
+    current = NULL;
+    end = false;
+    stopping = false;
+    error = nullptr;
+    thread = std::thread( &FileStream::readAhead, this );
+  }
+
+  void FileStream::stop(){
+    {
+      std::lock_guard< std::mutex > lock( mutex );
+      stopping = true;
+    }
+    changed.notify_all();
+    if ( thread.joinable() ){
+      thread.join();
+    }
+  }
+
+  void FileStream::rewind(){
+    stop();
+    reader->rewind();
+    start();
+  }
+
+  // readAhead: the reader thread. It fills the idle buffers in file order until the end of the file.
+  void FileStream::readAhead(){
+    std::vector< double > row;
+    int cols = reader->cols();
+    int dataCols = cols - targetCols;
+    try {
+      while ( true ){
+        Buffer *b;
+        {
+          std::unique_lock< std::mutex > lock( mutex );
+          changed.wait( lock, [this]{ return stopping || !idle.empty(); } );
+          if ( stopping ){
+            return;
+          }
+          b = idle.front();
+          idle.pop_front();
+        }
+
+        row.clear();
+        b->rows = reader->read( row, chunkRows );
+        if ( targetCols == 0 ){
+          b->x.swap( row );
+        }
+        else{
+          // split the target columns off the end of each row
+          b->x.resize( (size_t)b->rows * dataCols );
+          b->target.resize( (size_t)b->rows * targetCols );
+          for ( int i = 0; i < b->rows; i++ ){
+            const double *r = &row[(size_t)i * cols];
+            std::copy( r, r + dataCols, &b->x[(size_t)i * dataCols] );
+            std::copy( r + dataCols, r + cols, &b->target[(size_t)i * targetCols] );
+          }
+        }
+
+        std::lock_guard< std::mutex > lock( mutex );
+        if ( b->rows == 0 ){
+          end = true;
+          idle.push_back( b );
+          changed.notify_all();
+          return;
+        }
+        ready.push_back( b );
+        changed.notify_all();
+      }
+    }
+    catch ( ... ){
+      std::lock_guard< std::mutex > lock( mutex );
+      error = std::current_exception();
+      end = true;
+      changed.notify_all();
+    }
+  }
+
+  bool FileStream::next( Chunk &chunk ){
+    std::unique_lock< std::mutex > lock( mutex );
+    if ( current != NULL ){
+      // the previous chunk has been learned, so its buffer can be read into again
+      idle.push_back( current );
+      current = NULL;
+      changed.notify_all();
+    }
+    changed.wait( lock, [this]{ return !ready.empty() || end; } );
+    if ( ready.empty() ){
+      if ( error ){
+        std::exception_ptr e = error;
+        error = nullptr;
+        std::rethrow_exception( e );
+      }
+      return false;
+    }
+    current = ready.front();
+    ready.pop_front();
+
+    chunk.x = Rows( current->x.data(), current->rows, reader->cols() - targetCols );
+    chunk.target = targetCols == 0 ? Rows() : Rows( current->target.data(), current->rows, targetCols );
+    return true;
+  }
+
+}
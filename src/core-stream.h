@@ -0,0 +1,72 @@
+/****************************************************************************
+ *
+ *  core-stream.h
+ *  Out-of-core training data
+ *
+ *  FileStream reads a data file in chunks of a fixed number of rows, so a
+ *  data set larger than the memory can be learned. A background thread
+ *  reads the next chunks while the network learns the current one, and the
+ *  file is read from the start again for every epoch.
+ *
+ ****************************************************************************/
+
+#ifndef CORE_STREAM_H
+#define CORE_STREAM_H
+
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include "core.h"
+#include "core-io.h"
+
+namespace core {
+
+  /* FileStream: the rows of a CSV or binary matrix file as a RowSource. For ARTMAP, the last
+     targetCols columns of each row are the target. */
+  class FileStream : public RowSource {
+  public:
+    FileStream( const std::string &file, int chunkRows, int targetCols = 0 );
+    ~FileStream();
+
+    void rewind();
+    bool next( Chunk &chunk );
+
+    // cols: the number of data columns, without the target
+    int cols() const { return reader->cols() - targetCols; }
+    const std::vector< std::string > &names() const { return reader->names; }
+
+  private:
+    // the buffers cycle between the reader thread and the learner
+    struct Buffer {
+      std::vector< double > x;
+      std::vector< double > target;
+      int rows;
+    };
+    static const int BUFFERS = 3;
+
+    void start();
+    void stop();
+    void readAhead();
+
+    std::unique_ptr< RowReader > reader;
+    int chunkRows;
+    int targetCols;
+
+    Buffer buffers[BUFFERS];
+    std::deque< Buffer * > idle;    // the buffers to read into
+    std::deque< Buffer * > ready;   // the buffers read, in file order
+    Buffer *current;          // the buffer of the chunk being learned
+    bool end;                 // the reader has reached the end of the file
+    bool stopping;
+    std::exception_ptr error;
+    std::mutex mutex;
+    std::condition_variable changed;
+    std::thread thread;
+  };
+
+}
+
+#endif
@@ -0,0 +1,607 @@
+/****************************************************************************
+ *
+ *  core-topoart.cpp
+ *  TopoART on native network state
+ *
+ *
+ *
+ *  Reference:
+ *  1. Tscherepanow, M. (2010) "TopoART: A topology learning hierarchical ART network",
+ *  Proceedings of the International Conference on Artificial Neural Networks
+ *  (ICANN). LNCS, 6354, pp. 157–167.
+ *
+ ****************************************************************************/
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include "core.h"
+
+namespace core {
+
+  // key: the hash key of an undirected edge. The smaller node id is kept in the high bits
+  // so that (bm, sbm) and (sbm, bm) map to the same key.
+  long long EdgeSet::key( int n1, int n2 ){
+    long long lo = std::min( n1, n2 );
+    long long hi = std::max( n1, n2 );
+    return ( lo << 32 ) | hi;
+  }
+
+  void EdgeSet::assign( const std::vector< int > &edge ){
+    clear();
+    int s = edge.size();
+    nodes.reserve( s );
+    keys.reserve( s/2 );
+    for ( int j = 0; j + 1 < s; j += 2 ){
+      link( edge[j], edge[j+1] );
+    }
+  }
+
+  // link: link the bm and sbm nodes together. Returns false if they are already linked.
+  bool EdgeSet::link( int bm, int sbm ){
+    if ( !keys.insert( key( bm, sbm ) ).second ){
+      return false;
+    }
+    nodes.push_back( bm );
+    nodes.push_back( sbm );
+    return true;
+  }
+
+  // remap: renumber the nodes after the node candidates are removed. newIndices holds the new
+  // index of each old node, or -1 if the node is removed; edges with a removed node are dropped.
+  void EdgeSet::remap( const std::vector< int > &newIndices ){
+    keys.clear();
+    int z = nodes.size();
+    int e = 0;
+    for ( int j = 0; j + 1 < z; j += 2 ){
+      int neuron1 = newIndices[nodes[j]];
+      int neuron2 = newIndices[nodes[j+1]];
+      if ( neuron1 != -1 && neuron2 != -1 ){
+        // both neurons are permanent, so keep their edge
+        nodes[e] = neuron1;
+        nodes[e+1] = neuron2;
+        keys.insert( key( neuron1, neuron2 ) );
+        e += 2;
+      }
+    }
+    nodes.resize( e );
+  }
+
+  void EdgeSet::clear(){
+    keys.clear();
+    nodes.clear();
+  }
+
+  namespace Topo {
+
+    // the inputs queued between two modules by the staged learning
+    const int STAGE_RING_SIZE = 1024;
+
+    namespace {
+
+      // StageRing: a bounded lock-free queue of the inputs one module passes to the next in the
+      // staged learning, for one producer and one consumer thread. Each slot holds a code, a
+      // removal marker or the end marker. The consumer learns the code in its slot before
+      // popping it, so the code is copied once per module. While the ring is full or empty the
+      // thread yields; it gives up, returning false, once another stage has failed.
+      class StageRing {
+      public:
+        enum Tag { ROW, REMOVE, END };
+
+        StageRing( int codeLength, const std::atomic< bool > &failed ) :
+          codeLength( codeLength ), codes( (size_t)STAGE_RING_SIZE * codeLength ), tags( STAGE_RING_SIZE ),
+          failed( failed ) {}
+
+        bool push( Tag tag, const double *code = NULL ){
+          size_t t = tail.load( std::memory_order_relaxed );
+          while ( t - head.load( std::memory_order_acquire ) == (size_t)STAGE_RING_SIZE ){
+            if ( failed.load( std::memory_order_relaxed ) ){
+              return false;
+            }
+            std::this_thread::yield();
+          }
+          size_t slot = t % STAGE_RING_SIZE;
+          tags[slot] = tag;
+          if ( tag == ROW ){
+            std::copy( code, code + codeLength, &codes[slot * codeLength] );
+          }
+          tail.store( t + 1, std::memory_order_release );
+          return true;
+        }
+
+        // front: wait for the oldest input. Returns false if another stage failed.
+        bool front( Tag &tag, const double *&code ){
+          size_t h = head.load( std::memory_order_relaxed );
+          while ( tail.load( std::memory_order_acquire ) == h ){
+            if ( failed.load( std::memory_order_relaxed ) ){
+              return false;
+            }
+            std::this_thread::yield();
+          }
+          size_t slot = h % STAGE_RING_SIZE;
+          tag = tags[slot];
+          code = &codes[slot * codeLength];
+          return true;
+        }
+
+        void pop(){
+          head.store( head.load( std::memory_order_relaxed ) + 1, std::memory_order_release );
+        }
+
+      private:
+        int codeLength;
+        std::vector< double > codes;
+        std::vector< Tag > tags;
+        // Index: an index padded to a cache line, so the producer and the consumer each write
+        // their own line (C++11 can't allocate a type aligned with alignas( 64 ))
+        struct Index {
+          std::atomic< size_t > value;
+          char padding[64 - sizeof( std::atomic< size_t > )];
+          Index() : value( 0 ) {}
+          size_t load( std::memory_order order ) const { return value.load( order ); }
+          void store( size_t x, std::memory_order order ) { value.store( x, order ); }
+        };
+
+        const std::atomic< bool > &failed;
+        Index head;   // the next slot to read, written by the consumer
+        Index tail;   // the next slot to write, written by the producer
+      };
+
+    }
+
+    // rho: If there is just one module, then return the rho as is. If there are more than
+    // one module in the hierarchy, then the next module in the hierarchy will have
+    // rho = 0.5*(rho + 1) with rho being the vigilance value of the previous module.
+    double rho( double rho, int moduleId ){
+      for ( int i = 1; i <= moduleId; i++ ){
+        rho = 0.5*( rho + 1 );
+      }
+      return rho;
+    }
+
+    Module module( int id, double vigilance, int phi, double learningRate1, double learningRate2, int categorySize ){
+      Module module = ART::module( id, vigilance, learningRate1, categorySize );
+      module.beta1 = learningRate1;
+      module.beta2 = learningRate2;
+      module.phi = phi;
+      module.Jmax.push_back( -1 );  // sbm Jmax
+      return module;
+    }
+
+    Network create( Rule rule, int dimension, int num, double vigilance, double learningRate1, double learningRate2,
+                    int tau, int phi, int categorySize, int maxEpochs ){
+      if ( rule == RULE_ART1 ){
+        throw std::invalid_argument( "TopoART supports the fuzzy and hypersphere rules only." );
+      }
+      if ( vigilance < 0.0 || vigilance > 1.0 ){
+        throw std::invalid_argument( "The vigilance value must be between 0 and 1.0." );
+      }
+      if ( learningRate1 < 0.0 || learningRate1 > 1.0 ){
+        throw std::invalid_argument( "The learningRate1 value must be between 0 and 1.0." );
+      }
+      if ( learningRate2 < 0.0 || learningRate2 > 1.0 ){
+        throw std::invalid_argument( "The learningRate2 value must be between 0 and 1.0." );
+      }
+      if ( num < 2 ){
+        throw std::invalid_argument( "The num value must be at least 2." );
+      }
+      if ( tau < 0 ){
+        throw std::invalid_argument( "The tau value must be at least 0." );
+      }
+      if ( phi < 0 ){
+        throw std::invalid_argument( "The phi value must be at least 0." );
+      }
+      if ( categorySize < 1 ){
+        throw std::invalid_argument( "The categorySize value must be greater than 0." );
+      }
+      if ( maxEpochs < 1 ){
+        throw std::invalid_argument( "The maxEpochs value must be greater than 0." );
+      }
+      if ( dimension < 1 ){
+        throw std::invalid_argument( "The dimension value must be greater than 0." );
+      }
+
+      Network net;
+      net.type = NETWORK_TOPOART;
+      net.rule = rule;
+      net.dimension = dimension;
+      net.maxEpochs = maxEpochs;
+      net.tau = tau;
+      for ( int i = 0; i < num; i++ ){
+        if ( i > 0 ){
+          vigilance = rho( vigilance, i );
+        }
+        if ( vigilance > 0 ){
+          net.modules.push_back( module( i, vigilance, phi, learningRate1, learningRate2, categorySize ) );
+        }
+      }
+      return net;
+    }
+
+    void init( Network &net ){
+      ART::init( net );
+    }
+
+    // removeF2Nodes: remove the node candidates (nodes with accumulator counts < phi). The
+    // permanent nodes are compacted in place towards the front of the weight matrix, counter,
+    // accumulator and change vectors, so the storage capacity is kept for the next learning cycle.
+    // Returns the number of nodes removed.
+    int removeF2Nodes( Module &module ){
+
+      int l = module.numCategories;
+      int removed = 0;
+
+      // if the module is not empty without nodes
+      if ( l > 0 ){
+        int cols = module.weightDimension;
+
+        // newIndices holds the new position of each old node, or -1 if the node is removed
+        std::vector< int > newIndices( l, -1 );
+        int idx = 0;
+        for ( int k = 0; k < l; k++ ){
+          if ( module.n[k] < module.phi ){
+            // the changes of a removed node leave the epoch counters
+            module.changes -= module.change[k];
+            module.changed -= module.change[k] > 0;
+          }
+          else{
+            // a permanent node; move it down to the next free position
+            if ( idx != k ){
+              module.counter[idx] = module.counter[k];
+              module.n[idx] = module.n[k];
+              module.change[idx] = module.change[k];
+              std::copy( module.weight( k ), module.weight( k ) + cols, module.weight( idx ) );
+            }
+            newIndices[k] = idx;
+            idx++;
+          }
+        }
+
+        // clear the slots freed by the removed nodes so that new categories start from zero
+        for ( int k = idx; k < l; k++ ){
+          module.counter[k] = 0;
+          module.n[k] = 0;
+          module.change[k] = 0;
+        }
+
+        // remove edges: The edge neurons are simply the order index of the count (n) vector,
+        // so renumber them with the new indices of the permanent neurons
+        if ( idx > 0 ){
+          module.edges.remap( newIndices );
+        }
+        else{
+          module.edges.clear();
+        }
+
+        removed = l - idx;
+        module.numCategories = idx;
+        module.clearBlocks();
+      }
+      return removed;
+    }
+
+    // removeCandidates: remove the node candidates of a module, counting them in the stats
+    void removeCandidates( Network &net, int id ){
+      int removed = removeF2Nodes( net.modules[id] );
+      if ( ModuleStats *s = net.moduleStats( id ) ){
+        s->removals += removed;
+      }
+    }
+
+    void newCategory( const Network &net, Module &module, const double *x ){
+      ART::newCategory( net, module, x );
+      module.n[module.numCategories - 1]++;
+    }
+
+    // learn: learn the input d in module id. Returns true if the best matching node passed the
+    // phi filter, i.e. the input is passed on to the next module. If recurse is true, the next
+    // module learns the input right away; otherwise the caller is responsible for feeding it.
+    bool learn( Network &net, int id, const double *d, bool recurse = true ){
+
+      Module &module = net.modules[id];
+      ModuleStats *s = net.moduleStats( id );
+      PhaseTimer timer( s != NULL );
+      bool passed = false;
+
+      int nc = module.numCategories;
+      if ( nc == 0 ){
+        newCategory( net, module, d );
+        if ( s ){
+          s->search( 0, 0 );
+          s->updateTime += timer.lap();
+        }
+        return passed;
+      }
+
+      // Find the bm and sbm nodes in one pass: they are the two nodes with the highest
+      // activations among the nodes that pass the vigilance test. Ties go to the lower index,
+      // the same order as walking the sorted activations. The weights of other nodes are not
+      // changed by updating the bm, so all matches can be computed before any update.
+      int bm = -1;
+      int sbm = -1;
+      double T_bm = 0;
+      double T_sbm = 0;
+      int failures = 0;
+      Vigilance vigilance( net.rule, module, d );
+
+      for ( int k = 0; k < nc; k++ ){
+        const double *w = module.weight( k );
+        if ( vigilance.match( w, module.rho ) < module.rho ){
+          failures++;
+        }
+        else{
+          double T = activation( net.rule, module, d, w );
+          if ( bm == -1 || T > T_bm ){
+            sbm = bm;
+            T_sbm = T_bm;
+            bm = k;
+            T_bm = T;
+          }
+          else if ( sbm == -1 || T > T_sbm ){
+            sbm = k;
+            T_sbm = T;
+          }
+        }
+      }
+
+      if ( s ){
+        // all the nodes are examined in the fused pass
+        s->search( nc, failures );
+        s->searchTime += timer.lap();
+      }
+
+      if ( bm == -1 ){
+        // We haven't found a bm neuron, so create a new neuron
+        newCategory( net, module, d );
+        if ( s ){
+          s->updateTime += timer.lap();
+        }
+        return passed;
+      }
+
+      module.Jmax[0] = bm;
+      ART::weightUpdate( net, module, bm, d, module.beta1 );
+      module.counter[bm]++;
+      module.n[bm]++;
+      if ( s ){
+        s->updateTime += timer.lap();
+      }
+
+      // move up to the next module if count >= phi
+      if ( module.n[bm] >= module.phi ) {
+        passed = true;
+        if ( recurse && net.hasMoreModules( id ) ){
+          // match >= rho_a and count > phi, then activate net b
+          learn( net, id+1, d );
+        }
+      }
+
+      // both bm and sbm neurons are found, then link them together
+      if ( sbm != -1 ){
+        PhaseTimer sbmTimer( s != NULL );
+        module.Jmax[1] = sbm;
+        ART::weightUpdate( net, module, sbm, d, module.beta2 );
+        module.edges.link( bm, sbm );
+        if ( s ){
+          s->updateTime += sbmTimer.lap();
+        }
+      }
+
+      return passed;
+    }
+
+    // learnRows: learn the rows of x in order, removing the node candidates of all modules
+    // at the end of every learning cycle of tau rows
+    void learnRows( Network &net, Rows x, int &tau ){
+      std::vector< double > code( codeDimension( net.rule, net.dimension ) );
+      for ( int i = 0; i < x.rows; i++ ){
+        processCode( net.rule, x.row( i ), x.cols, code.data() );
+        learn( net, 0, code.data() );
+        tau++;
+        if ( tau == net.tau ){
+          // Reach the end of the learning cycle. Remove node candidates.
+          for ( int id = 0; id < net.numModules(); id++ ){
+            removeCandidates( net, id );
+          }
+          tau = 0;
+        }
+      }
+    }
+
+    // learnStaged: learn the rows of x module by module instead of recursing into the next module
+    // for every input. Each module learns on its own thread: module 0 learns the rows and queues
+    // those that passed its phi filter on a StageRing to module 1, which learns them and queues
+    // its own, and so on. Each module depends only on the rows it receives and on when its node
+    // candidates are removed, so a removal marker is queued at every tau cycle and forwarded up
+    // the hierarchy in stream order. This gives the same result as the recursive learning. The
+    // modules touch only their own state and stats, so they need no other synchronization.
+    void learnStaged( Network &net, Rows x, int &tau ){
+
+      int numModules = net.numModules();
+      int codeLength = codeDimension( net.rule, net.dimension );
+      std::atomic< bool > failed( false );
+      std::vector< std::unique_ptr< StageRing > > ring;
+      for ( int id = 1; id < numModules; id++ ){
+        ring.emplace_back( new StageRing( codeLength, failed ) );
+      }
+
+      parallel( numModules, [&]( int id ){
+        bool hasNext = net.hasMoreModules( id );
+        try {
+          if ( id == 0 ){
+            std::vector< double > code( codeLength );
+            for ( int i = 0; i < x.rows; i++ ){
+              processCode( net.rule, x.row( i ), x.cols, code.data() );
+              if ( learn( net, 0, code.data(), false ) && hasNext && !ring[0]->push( StageRing::ROW, code.data() ) ){
+                return;
+              }
+              tau++;
+              if ( tau == net.tau ){
+                // Reach the end of the learning cycle. Remove node candidates.
+                removeCandidates( net, 0 );
+                if ( hasNext && !ring[0]->push( StageRing::REMOVE ) ){
+                  return;
+                }
+                tau = 0;
+              }
+            }
+            if ( hasNext ){
+              ring[0]->push( StageRing::END );
+            }
+            return;
+          }
+
+          StageRing &input = *ring[id-1];
+          StageRing::Tag tag;
+          const double *code;
+          while ( input.front( tag, code ) ){
+            bool forwarded = true;
+            if ( tag == StageRing::END ){
+              if ( hasNext ){
+                ring[id]->push( StageRing::END );
+              }
+              input.pop();
+              return;
+            }
+            if ( tag == StageRing::REMOVE ){
+              removeCandidates( net, id );
+              forwarded = !hasNext || ring[id]->push( StageRing::REMOVE );
+            }
+            else if ( learn( net, id, code, false ) && hasNext ){
+              forwarded = ring[id]->push( StageRing::ROW, code );
+            }
+            input.pop();
+            if ( !forwarded ){
+              return;
+            }
+          }
+        }
+        catch ( ... ){
+          // release the other stages waiting on the rings
+          failed = true;
+          throw;
+        }
+      } );
+    }
+
+    // saveEdges: link the clusters of the learned edges
+    void saveEdges( Module &module ){
+      module.linkedClusters.clear();
+      if ( !module.edges.nodes.empty() ){
+        std::vector< int > nodes( module.numCategories );
+        for ( int k = 0; k < module.numCategories; k++ ){
+          nodes[k] = k;
+        }
+        module.linkedClusters = linkClusters( module.edges.nodes, nodes );
+      }
+    }
+
+    void train( Network &net, Rows x, bool staged ){
+      if ( x.cols != net.dimension ){
+        throw std::invalid_argument( "The number of columns in the data must be the dimension of the network." );
+      }
+      MemorySource source( x );
+      train( net, source, staged );
+    }
+
+    // train: the data is read from the source once per epoch, chunk by chunk. The learning
+    // cycle of tau rows runs across the chunks.
+    void train( Network &net, RowSource &source, bool staged ){
+      startStats( net );
+      PhaseTimer timer( net.stats != NULL );
+      EpochProgress progress;
+      ConvergenceTest convergence( net );
+      long rows = 0;
+
+      int tau = 0;
+      int numModules = net.numModules();
+
+      for ( int epoch = 1; epoch <= net.maxEpochs; epoch++ ){
+        Chunk chunk;
+        source.rewind();
+        while ( source.next( chunk ) ){
+          if ( chunk.x.cols != net.dimension ){
+            throw std::invalid_argument( "The number of columns in the data must be the dimension of the network." );
+          }
+          if ( staged ){
+            learnStaged( net, chunk.x, tau );
+          }
+          else{
+            learnRows( net, chunk.x, tau );
+          }
+          rows += chunk.x.rows;
+        }
+        int change = ART::totalChange( net );
+        StopReason reason = convergence.epoch( net, epoch, change );
+        progress.epoch( net, epoch, rows, change, reason );
+        if ( reason != STOP_NONE && reason != STOP_MAX_EPOCHS ) {
+          net.epochs = epoch;
+          break;
+        } else if ( epoch < net.maxEpochs ){
+          // as in ART::train, the counters of the last epoch are kept for inspection
+          for ( Module &module : net.modules ){
+            ART::changeReset( module );
+            ART::counterReset( module );
+          }
+        }
+      }
+
+      for ( int id = 0; id < numModules; id++ ){
+        Module &module = net.modules[id];
+        removeCandidates( net, id );  // remove all node candidates one last time
+        module.trim();
+        saveEdges( module );
+      }
+      // all node candidates are removed, so a new learning cycle starts
+      net.tauCounter = 0;
+      if ( net.stats ){
+        net.stats->add( rows, timer.lap() );
+      }
+    }
+
+    // partialTrain: learn the rows of x once as the next part of a stream. Unlike train, the
+    // node candidates, their accumulators and the position in the learning cycle are kept in
+    // the network between calls, and the weight storage is not trimmed, so the network can be
+    // fed with mini-batches. The node candidates are only removed at the end of each cycle.
+    void partialTrain( Network &net, Rows x ){
+      if ( x.cols != net.dimension ){
+        throw std::invalid_argument( "The number of columns in the data must be the dimension of the network." );
+      }
+
+      for ( Module &module : net.modules ){
+        // the changes reported are those made by this part of the stream
+        ART::changeReset( module );
+      }
+      startStats( net );
+
+      int tau = net.tauCounter;
+      learnRows( net, x, tau );
+      net.tauCounter = tau;
+
+      for ( Module &module : net.modules ){
+        saveEdges( module );
+      }
+    }
+
+    // predict: the category of module id for each row of x and its linked cluster, -1 if none
+    void predict( Network &net, int id, Rows x, std::vector< int > &category, std::vector< int > &linkedCluster ){
+      if ( id < 0 || id >= net.numModules() ){
+        throw std::invalid_argument( "The module id is out of range." );
+      }
+
+      const Module &module = net.modules[id];
+      std::vector< int > clusters = clusterIndex( module.linkedClusters, module.numCategories );
+
+      category = ART::predict( net, id, x );
+      linkedCluster.resize( x.rows );
+      for ( int i = 0; i < x.rows; i++ ){
+        int result = category[i];
+        linkedCluster[i] = ( result < 0 || result >= (int)clusters.size() ) ? -1 : clusters[result];
+      }
+    }
+
+  }
+
+}
@@ -0,0 +1,336 @@
+/****************************************************************************
+ *
+ *  core-utils.cpp
+ *  Native ART utilities
+ *
+ ****************************************************************************/
+
+#include <algorithm>
+#include <numeric>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <exception>
+#include <thread>
+#include <unordered_map>
+#include "core.h"
+
+namespace core {
+
+  // sortIndex: Sort the values in descending order and return the indices of the values.
+  // Equal values keep their order.
+  void sortIndex( const std::vector< double > &x, std::vector< int > &idx ){
+    idx.resize( x.size() );
+    std::iota( idx.begin(), idx.end(), 0 );
+    std::stable_sort( idx.begin(), idx.end(), [&x]( int i1, int i2 ) { return x[i1] > x[i2]; } );
+  }
+
+  // extendRange: widen the column ranges by the rows of x, ignoring the missing values
+  static void extendRange( Rows x, std::vector< double > &minimum, std::vector< double > &maximum ){
+    for ( int i = 0; i < x.rows; i++ ){
+      const double *r = x.row( i );
+      for ( int j = 0; j < x.cols; j++ ){
+        if ( !std::isnan( r[j] ) ){
+          minimum[j] = std::min( minimum[j], r[j] );
+          maximum[j] = std::max( maximum[j], r[j] );
+        }
+      }
+    }
+  }
+
+  // columnRange: the minimum and maximum of each column, ignoring the missing values
+  void columnRange( Rows x, std::vector< double > &minimum, std::vector< double > &maximum ){
+    minimum.assign( x.cols, std::numeric_limits< double >::infinity() );
+    maximum.assign( x.cols, -std::numeric_limits< double >::infinity() );
+    extendRange( x, minimum, maximum );
+  }
+
+  // startStats: make room for the counters of all modules, if the stats are recorded
+  void startStats( Network &net ){
+    if ( net.stats != NULL && (int)net.stats->modules.size() < net.numModules() ){
+      net.stats->modules.resize( net.numModules() );
+    }
+  }
+
+  // offer: report the progress, unless the previous report was less than interval seconds ago
+  void ProgressSink::offer( const Progress &p ){
+    if ( !p.done && last >= 0 && p.elapsed - last < interval ){
+      return;
+    }
+    last = p.elapsed;
+    report( p );
+  }
+
+  // epoch: offer the state of the network after an epoch to its progress sink, if it has one
+  void EpochProgress::epoch( const Network &net, int epoch, long rows, int changes, StopReason stopReason ) const {
+    if ( net.progress == NULL ){
+      return;
+    }
+    Progress p;
+    p.epoch = epoch;
+    p.maxEpochs = net.maxEpochs;
+    p.changes = changes;
+    for ( const Module &module : net.modules ){
+      p.moduleChanges.push_back( module.changes );
+      p.categories.push_back( module.numCategories );
+    }
+    p.rows = rows;
+    p.elapsed = std::chrono::duration< double >( std::chrono::steady_clock::now() - start ).count();
+    p.rowsPerSecond = p.elapsed > 0 ? rows / p.elapsed : 0;
+    p.done = stopReason != STOP_NONE;
+    p.stopReason = stopReason;
+    net.progress->offer( p );
+  }
+
+  // ConvergenceTest: start the epoch counters from the changes left by the previous training
+  ConvergenceTest::ConvergenceTest( Network &net ) : stable( 0 ){
+    for ( Module &module : net.modules ){
+      module.changes = ART::moduleChange( module );
+      module.changed = std::count_if( module.change.begin(), module.change.end(), []( int c ) { return c > 0; } );
+      module.weightDelta = 0;
+      categories.push_back( module.numCategories );
+    }
+    net.mapfield.changes = std::accumulate( net.mapfield.change.begin(), net.mapfield.change.end(), 0 );
+    net.stopReason = STOP_NONE;
+  }
+
+  // epoch: why train stops after the epoch, or STOP_NONE to go on. An epoch without changes
+  // comes first, as it is the only criterion of the original algorithm.
+  StopReason ConvergenceTest::epoch( Network &net, int epoch, int changes ){
+    const Convergence &c = net.convergence;
+    int numCategories = 0;
+    int changed = 0;
+    double weightDelta = 0;
+    bool grown = false;
+    for ( size_t i = 0; i < net.modules.size(); i++ ){
+      const Module &module = net.modules[i];
+      numCategories += module.numCategories;
+      changed += module.changed;
+      weightDelta += module.weightDelta;
+      grown = grown || module.numCategories > categories[i];
+      categories[i] = module.numCategories;
+    }
+    stable = grown ? 0 : stable + 1;
+
+    StopReason reason = STOP_NONE;
+    if ( changes == 0 ){
+      reason = STOP_NO_CHANGE;
+    }
+    else if ( c.changedFraction > 0 && changed < c.changedFraction * numCategories ){
+      reason = STOP_CHANGED_FRACTION;
+    }
+    else if ( c.weightDelta > 0 && weightDelta < c.weightDelta ){
+      reason = STOP_WEIGHT_DELTA;
+    }
+    else if ( c.stableEpochs > 0 && stable >= c.stableEpochs ){
+      reason = STOP_STABLE_CATEGORIES;
+    }
+    else if ( epoch >= net.maxEpochs ){
+      reason = STOP_MAX_EPOCHS;
+    }
+    net.stopReason = reason;
+    return reason;
+  }
+
+  std::string stopReasonName( StopReason reason ){
+    switch ( reason ){
+      case STOP_NO_CHANGE: return "noChange";
+      case STOP_CHANGED_FRACTION: return "changedFraction";
+      case STOP_WEIGHT_DELTA: return "weightDelta";
+      case STOP_STABLE_CATEGORIES: return "stableCategories";
+      case STOP_MAX_EPOCHS: return "maxEpochs";
+      default: return "none";
+    }
+  }
+
+  // initR_bar: estimate the radius of the data for all modules of a hypersphere network, if
+  // it is not estimated yet. Only the first data the network learns from is used.
+  void initR_bar( Network &net, Rows x ){
+    MemorySource source( x );
+    initR_bar( net, source );
+  }
+
+  // initR_bar: as above, for a data set that is read in chunks. This takes one pass over the data.
+  void initR_bar( Network &net, RowSource &source ){
+    if ( net.rule != RULE_HYPERSPHERE || net.modules.empty() || net.modules[0].hasR_bar ){
+      return;
+    }
+    std::vector< double > minimum( net.dimension, std::numeric_limits< double >::infinity() );
+    std::vector< double > maximum( net.dimension, -std::numeric_limits< double >::infinity() );
+    Chunk chunk;
+    source.rewind();
+    while ( source.next( chunk ) ){
+      if ( chunk.x.cols != net.dimension ){
+        throw std::invalid_argument( "The number of columns in the data must be the dimension of the network." );
+      }
+      extendRange( chunk.x, minimum, maximum );
+    }
+    initR_bar( net, minimum, maximum );
+  }
+
+  // initR_bar: as above, from the column ranges of the data when they are already known, e.g.
+  // computed while the data was read
+  void initR_bar( Network &net, const std::vector< double > &minimum, const std::vector< double > &maximum ){
+    if ( net.rule != RULE_HYPERSPHERE || net.modules.empty() || net.modules[0].hasR_bar ){
+      return;
+    }
+    if ( (int)minimum.size() != net.dimension ){
+      throw std::invalid_argument( "The number of columns in the data must be the dimension of the network." );
+    }
+    double rbar = hypersphere::R_bar( minimum, maximum );
+    for ( Module &module : net.modules ){
+      module.R_bar = rbar;
+      module.hasR_bar = true;
+    }
+  }
+
+  // numThreads: the number of threads to use, all the hardware threads if threads is 0
+  int numThreads( int threads ){
+    if ( threads > 0 ){
+      return threads;
+    }
+    int n = std::thread::hardware_concurrency();
+    return n > 0 ? n : 1;
+  }
+
+  // parallel: run f( 0 ), ..., f( n - 1 ), each on its own thread, and wait for them. The first
+  // exception thrown by f is rethrown here.
+  void parallel( int n, const std::function< void( int ) > &f ){
+    if ( n == 1 ){
+      f( 0 );
+      return;
+    }
+    std::vector< std::exception_ptr > errors( n );
+    std::vector< std::thread > threads;
+    for ( int i = 0; i < n; i++ ){
+      threads.push_back( std::thread( [&f, &errors, i]{
+        try {
+          f( i );
+        }
+        catch ( ... ){
+          errors[i] = std::current_exception();
+        }
+      } ) );
+    }
+    for ( std::thread &t : threads ){
+      t.join();
+    }
+    for ( std::exception_ptr &e : errors ){
+      if ( e ){
+        std::rethrow_exception( e );
+      }
+    }
+  }
+
+  // findRoot: find the root of a node in the union-find forest, halving the path on the way
+  static int findRoot( std::vector< int > &parent, int node ){
+    while ( parent[node] != node ){
+      parent[node] = parent[parent[node]];
+      node = parent[node];
+    }
+    return node;
+  }
+
+  // linkClusters: the groups of nodes that are linked together by the edges (node pairs). The
+  // groups are ordered by the first appearance of their nodes in the edges, followed by the
+  // nodes that are not linked to any other node.
+  std::vector< std::vector< int > > linkClusters( const std::vector< int > &edges, const std::vector< int > &nodes ){
+    int nedges = edges.size();
+    int nnodes = nodes.size();
+
+    // the union-find forest is indexed by the node ids, so size it by the largest id
+    int size = 0;
+    for ( int i = 0; i < nedges; i++ ){
+      size = std::max( size, edges[i] + 1 );
+    }
+    for ( int i = 0; i < nnodes; i++ ){
+      size = std::max( size, nodes[i] + 1 );
+    }
+    std::vector< int > parent( size );
+    std::iota( parent.begin(), parent.end(), 0 );
+
+    // union the two nodes of every edge
+    for ( int i = 0; i + 1 < nedges; i += 2 ){
+      int r1 = findRoot( parent, edges[i] );
+      int r2 = findRoot( parent, edges[i+1] );
+      if ( r1 != r2 ){
+        parent[std::max( r1, r2 )] = std::min( r1, r2 );
+      }
+    }
+
+    std::vector< int > group( size, -1 );
+    std::vector< bool > seen( size, false );
+    std::vector< std::vector< int > > g;
+    for ( int i = 0; i < nedges; i++ ){
+      int node = edges[i];
+      if ( seen[node] ){
+        continue;
+      }
+      seen[node] = true;
+      int root = findRoot( parent, node );
+      if ( group[root] == -1 ){
+        group[root] = g.size();
+        g.push_back( std::vector< int >() );
+      }
+      g[group[root]].push_back( node );
+    }
+    for ( int i = 0; i < nnodes; i++ ){
+      int node = nodes[i];
+      if ( !seen[node] ){
+        seen[node] = true;
+        g.push_back( std::vector< int >( 1, node ) );
+      }
+    }
+
+    return g;
+  }
+
+  // clusterIndex: map each node to the index of its linked cluster. Nodes that do not
+  // belong to any cluster are mapped to -1.
+  std::vector< int > clusterIndex( const std::vector< std::vector< int > > &linkedClusters, int numNodes ){
+    std::vector< int > index( numNodes, -1 );
+    int l = linkedClusters.size();
+    for ( int i = 0; i < l; i++ ){
+      for ( int node : linkedClusters[i] ){
+        if ( node >= 0 && node < numNodes ){
+          index[node] = i;
+        }
+      }
+    }
+    return index;
+  }
+
+  // adjustedRandIndex: the agreement of two partitions of the same items, given as the label
+  // of each item: 1 if they are the same, around 0 if they agree by chance
+  double adjustedRandIndex( const std::vector< int > &a, const std::vector< int > &b ){
+    if ( a.size() != b.size() ){
+      throw std::invalid_argument( "The partitions have different sizes." );
+    }
+    std::unordered_map< long long, long > pairs;
+    std::unordered_map< int, long > rows, cols;
+    for ( size_t i = 0; i < a.size(); i++ ){
+      pairs[( (long long)a[i] << 32 ) ^ (unsigned int)b[i]]++;
+      rows[a[i]]++;
+      cols[b[i]]++;
+    }
+    auto choose2 = []( long n ){ return 0.5 * n * ( n - 1 ); };
+    double index = 0, sumA = 0, sumB = 0;
+    for ( const auto &p : pairs ){
+      index += choose2( p.second );
+    }
+    for ( const auto &p : rows ){
+      sumA += choose2( p.second );
+    }
+    for ( const auto &p : cols ){
+      sumB += choose2( p.second );
+    }
+    double total = choose2( a.size() );
+    double expected = total > 0 ? sumA * sumB / total : 0;
+    double maximum = 0.5 * ( sumA + sumB );
+    if ( maximum == expected ){
+      return 1;
+    }
+    return ( index - expected ) / ( maximum - expected );
+  }
+
+}
@@ -0,0 +1,641 @@
+/****************************************************************************
+ *
+ *  core.h
+ *  The ART engine on plain C++ types
+ *
+ *  The learning rules and the ART, ARTMAP and TopoART algorithms work on
+ *  native network state and row-major data, without R. The Rcpp functions
+ *  convert the R networks to and from this state (native.h), and the rart
+ *  command line tool uses it directly.
+ *
+ ****************************************************************************/
+
+#ifndef CORE_H
+#define CORE_H
+
+#include <vector>
+#include <string>
+#include <functional>
+#include <chrono>
+#include <memory>
+#include <unordered_set>
+
+namespace core {
+
+  // default activation and match function parameters of a module
+  const double ALPHA = 0.001;
+  const double EPSILON = 0.000001;
+
+  enum Rule {
+    RULE_FUZZY = 0,
+    RULE_HYPERSPHERE = 1,
+    RULE_ART1 = 2
+  };
+
+  enum NetworkType {
+    NETWORK_ART = 0,
+    NETWORK_ARTMAP = 1,
+    NETWORK_TOPOART = 2
+  };
+
+  /* Rows: a read-only view of a row-major matrix, e.g. the rows of a data set */
+  struct Rows {
+    const double *data;
+    int rows;
+    int cols;
+
+    Rows() : data( NULL ), rows( 0 ), cols( 0 ) {}
+    Rows( const double *data, int rows, int cols ) : data( data ), rows( rows ), cols( cols ) {}
+    const double *row( int i ) const { return data + (size_t)i * cols; }
+  };
+
+  /* Chunk: a part of a data set, the rows of the data and, for ARTMAP, the rows of the target */
+  struct Chunk {
+    Rows x;
+    Rows target;
+  };
+
+  /* RowSource: a data set that is read in chunks, in order. The training reads it from the
+     start again for every epoch. */
+  struct RowSource {
+    virtual ~RowSource() {}
+    // rewind: start again from the first row
+    virtual void rewind() = 0;
+    // next: the next chunk, or false at the end. The chunk is valid until the next call.
+    virtual bool next( Chunk &chunk ) = 0;
+  };
+
+  /* MemorySource: a data set in memory, read as a single chunk */
+  struct MemorySource : RowSource {
+    Chunk chunk;
+    bool done;
+
+    MemorySource( Rows x, Rows target = Rows() ) : done( false ) { chunk.x = x; chunk.target = target; }
+    void rewind() { done = false; }
+    bool next( Chunk &c ) {
+      if ( done ){
+        return false;
+      }
+      c = chunk;
+      done = true;
+      return true;
+    }
+  };
+
+  /* EdgeSet: the edges between the F2 nodes of a TopoART module. The node pairs are kept in
+     insertion order in the flat vector nodes (the same layout as the module's "edge" vector),
+     while the hash set keys answers whether a pair is already linked in constant time. */
+  struct EdgeSet {
+    std::unordered_set< long long > keys;
+    std::vector< int > nodes;
+
+    static long long key( int n1, int n2 );
+    void assign( const std::vector< int > &edge );
+    bool link( int bm, int sbm );
+    void remap( const std::vector< int > &newIndices );
+    void clear();
+  };
+
+  /* CategoryBlocks: a copy of the weights of a module stored category-major, in blocks of LANES
+     categories with the values of each dimension side by side, so the activation of a block is
+     computed for all its categories at once with vector instructions. Modules with at most
+     MAX_DIMENSION values per weight use it (see Module::blocked), where a loop over the few values
+     of one category leaves the vector lanes idle. */
+  struct CategoryBlocks {
+    static const int LANES = 8;
+    static const int MAX_DIMENSION = 16;
+
+    std::vector< double > v;   // value i of category k at ( k/LANES * dimension + i ) * LANES + k%LANES
+    int dimension;
+    int size;                  // the categories copied
+
+    CategoryBlocks() : dimension( 0 ), size( 0 ) {}
+    const double *block( int b ) const { return &v[(size_t)b * dimension * LANES]; }
+    void set( int k, const double *w );
+    void clear() { v.clear(); size = 0; }
+  };
+
+  /* CategoryEnvelopes: bounds on the weights of the categories of a module in blocks of SIZE
+     categories, the largest (hi) and smallest (lo) value of each dimension and, for the
+     hypersphere rule, a ball enclosing the centres. For binary ART1 weights hi is the OR of the
+     block. The search of a large module bounds the activation and match of a whole block from them
+     (see blockBound) and skips the blocks that cannot hold the resonant category. A block is
+     recomputed when one of its categories has changed. */
+  struct CategoryEnvelopes {
+    static const int SIZE = 64;
+
+    std::vector< double > hi;       // value i of block b at b * dimension + i
+    std::vector< double > lo;
+    std::vector< double > centre;   // hypersphere: the centre of the ball of block b at b * dimension
+    std::vector< double > radius;
+    std::vector< char > bounded;    // whether the values of the block are all finite
+    std::vector< char > stale;      // whether a category of the block has changed
+    int dimension;
+    int size;                       // the categories covered
+
+    CategoryEnvelopes() : dimension( 0 ), size( 0 ) {}
+    int blocks() const { return ( size + SIZE - 1 )/SIZE; }
+    void touch( int k ) { if ( k < size ) stale[k/SIZE] = 1; }
+    void clear() { size = 0; }
+  };
+
+  /* CategoryLog: the categories of a module whose weights were written since the log was cleared,
+     recorded only while it is on, so that a copy of the weights kept outside the engine can be
+     brought up to date category by category (see native::syncNetwork). all is set instead when
+     the categories were moved or the storage was replaced. */
+  struct CategoryLog {
+    bool on;
+    bool all;
+    std::vector< int > categories;  // in the order they were first written
+    std::vector< char > written;    // whether category k is in categories
+
+    CategoryLog() : on( false ), all( false ) {}
+    void touch( int k ){
+      if ( !on || all ){
+        return;
+      }
+      if ( k >= (int)written.size() ){
+        written.resize( k + 1, 0 );
+      }
+      if ( !written[k] ){
+        written[k] = 1;
+        categories.push_back( k );
+      }
+    }
+    void touchAll() { if ( on ) all = true; }
+    void clear() { for ( int k : categories ) written[k] = 0; categories.clear(); all = false; }
+  };
+
+  /* Weights: the weight storage of a module, category by category. The values are held in a
+     vector or, for a network loaded from a model file, viewed in place in the mapped file (see
+     loadNetwork), which the view keeps open. Reading a view costs nothing; the first call that
+     may change it (the non-const data, resize or swap) copies it into the vector. */
+  class Weights {
+  public:
+    Weights() : view( NULL ), length( 0 ) {}
+    Weights &operator=( const std::vector< double > &v ) { release(); values = v; return *this; }
+    const double *data() const { return view != NULL ? view : values.data(); }
+    double *data() { own(); return values.data(); }
+    size_t size() const { return view != NULL ? length : values.size(); }
+    bool empty() const { return size() == 0; }
+    bool viewed() const { return view != NULL; }
+    void assign( size_t n, double x ) { release(); values.assign( n, x ); }
+    void resize( size_t n, double x = 0 ) { own(); values.resize( n, x ); }
+    void swap( std::vector< double > &v ) { own(); values.swap( v ); }
+    void setView( const double *p, size_t n, const std::shared_ptr< const void > &source ){
+      values.clear();
+      view = p;
+      length = n;
+      mapping = source;
+    }
+
+  private:
+    void own() { if ( view != NULL ){ values.assign( view, view + length ); release(); } }
+    void release() { view = NULL; length = 0; mapping.reset(); }
+
+    std::vector< double > values;
+    const double *view;
+    size_t length;
+    std::shared_ptr< const void > mapping;
+  };
+
+  /* Module: an ART module. The weights of the categories are stored row by row in w; the
+     storage holds rows categories and grows by capacity rows when it runs out. Small weights are
+     also kept in blocks, and every module keeps envelopes: the functions that change a weight
+     call updateBlock, the categories added are copied by syncBlocks and syncEnvelopes before the
+     next search, and any other change of w must be followed by clearBlocks(). */
+  struct Module {
+    int id;
+    int weightDimension;
+    int capacity;             // number of categories to add when the module runs out of categories
+    int numCategories;        // number of categories created during learning
+    int rows;                 // number of categories the storage holds
+    double alpha;             // activation function parameter
+    double epsilon;           // match function parameter
+    double rho;               // vigilance parameter
+    double beta;              // learning parameter
+    double R_bar;             // hypersphere: the radius of the data
+    bool hasR_bar;
+    Weights w;
+    std::vector< int > counter;
+    std::vector< int > change;
+    std::vector< int > Jmax;  // the bm node index (and the sbm node index for TopoART)
+
+    // the counters of the current epoch, kept up to date by learning for the convergence test
+    int changes;              // the sum of change
+    int changed;              // the categories with a change
+    double weightDelta;       // the sum of the absolute weight changes
+
+    // TopoART
+    double beta1;             // learning rate of the bm node
+    double beta2;             // learning rate of the sbm node
+    int phi;                  // counter threshold
+    std::vector< int > n;     // accumulator for noise filtering
+    EdgeSet edges;
+    std::vector< std::vector< int > > linkedClusters;
+
+    mutable CategoryBlocks blocks;
+    mutable CategoryEnvelopes envelopes;
+    mutable CategoryLog writes;
+
+    Module();
+    double *weight( int k ) { return w.data() + (size_t)k * weightDimension; }
+    const double *weight( int k ) const { return w.data() + (size_t)k * weightDimension; }
+    bool blocked() const { return weightDimension <= CategoryBlocks::MAX_DIMENSION; }
+    void syncBlocks() const;
+    void syncEnvelopes( Rule rule ) const;
+    void updateBlock( int k ) const { if ( k < blocks.size ) blocks.set( k, weight( k ) ); envelopes.touch( k ); writes.touch( k ); }
+    void clearBlocks() const { blocks.clear(); envelopes.clear(); writes.touchAll(); }
+    void init( int weightDimension );
+    void grow();
+    void trim();
+  };
+
+  /* Mapfield: the ARTMAP map field. The simplified map field keeps the label of each module a
+     category; the standard map field is a matrix with a row for each module a category and a
+     column for each module b category. */
+  struct Mapfield {
+    int id;
+    int capacity;
+    double alpha;
+    double epsilon;
+    double rho;
+    double beta;
+    std::vector< int > change;
+    int changes;              // the sum of change in the current epoch
+
+    // simplified
+    std::vector< int > label;
+    int numCategories;
+
+    // standard
+    std::vector< double > w;  // rows x cols, row-major
+    int rows;
+    int cols;
+    int numCategories_a;
+    int numCategories_b;
+    int weightDimension;
+
+    Mapfield();
+    double *weight( int a ) { return &w[(size_t)a * cols]; }
+    const double *weight( int a ) const { return &w[(size_t)a * cols]; }
+  };
+
+  /* ModuleStats: the counters of the category search in a module */
+  struct ModuleStats {
+    long searches;              // inputs searched
+    std::vector< long > depth;  // depth[d]: the searches that examined d candidates
+    long vigilanceFailures;     // candidates that failed the vigilance test
+    long matchTrackingResets;   // ARTMAP module a: the vigilance raised after a map field mismatch
+    long newCategories;
+    long removals;              // TopoART: node candidates removed
+    long blocksVisited;         // the bounded search of the large modules: blocks of categories evaluated
+    long blocksMatchPruned;     // blocks skipped by the match bound
+    long blocksActivationPruned;  // blocks left unvisited by the activation bound
+    double activationTime;      // seconds computing and sorting the activations (the block bounds)
+    double searchTime;          // seconds in the vigilance tests (the blocks visited)
+    double updateTime;          // seconds updating the weights and creating the categories
+
+    ModuleStats();
+    void search( int depth, int failures );
+  };
+
+  /* Stats: the counters recorded by learn and classify while Network::stats is set. They are off
+     by default, so the hot path only pays for a null check. */
+  struct Stats {
+    long rows;                  // rows learned or classified
+    double time;                // seconds in total
+    std::vector< ModuleStats > modules;
+
+    Stats() : rows( 0 ), time( 0 ) {}
+    explicit Stats( int numModules ) : rows( 0 ), time( 0 ), modules( numModules ) {}
+    void add( long n, double seconds ) { rows += n; time += seconds; }
+  };
+
+  /* PhaseTimer: the seconds since the last lap, for the phase times of the stats. It does not
+     read the clock when it is off. */
+  struct PhaseTimer {
+    bool on;
+    std::chrono::steady_clock::time_point last;
+
+    explicit PhaseTimer( bool on ) : on( on ) { if ( on ) last = std::chrono::steady_clock::now(); }
+    double lap() {
+      if ( !on ){
+        return 0;
+      }
+      std::chrono::steady_clock::time_point t = std::chrono::steady_clock::now();
+      double s = std::chrono::duration< double >( t - last ).count();
+      last = t;
+      return s;
+    }
+  };
+
+  /* Convergence: the criteria that end train before maxEpochs, besides an epoch without changes.
+     Each criterion is off at 0. */
+  struct Convergence {
+    double changedFraction;   // less than this fraction of the categories changed in an epoch
+    double weightDelta;       // the weights moved by less than this in an epoch, as the sum of the absolute changes
+    int stableEpochs;         // the number of categories has not grown for this many epochs
+
+    Convergence() : changedFraction( 0 ), weightDelta( 0 ), stableEpochs( 0 ) {}
+  };
+
+  // StopReason: why train stopped
+  enum StopReason { STOP_NONE, STOP_NO_CHANGE, STOP_CHANGED_FRACTION, STOP_WEIGHT_DELTA, STOP_STABLE_CATEGORIES,
+                    STOP_MAX_EPOCHS };
+
+  /* Progress: the state of train after an epoch */
+  struct Progress {
+    int epoch;
+    int maxEpochs;
+    int changes;                      // changes in the epoch over all modules (and the ARTMAP map field)
+    std::vector< int > moduleChanges;
+    std::vector< int > categories;    // the categories of each module
+    long rows;                        // rows learned since train started
+    double elapsed;                   // seconds since train started
+    double rowsPerSecond;
+    bool done;                        // the last epoch: the network has converged or reached maxEpochs
+    StopReason stopReason;            // why train stopped, on the last epoch
+  };
+
+  /* ProgressSink: receives the progress of train while Network::progress is set. Reports less
+     than interval seconds after the previous one are dropped, except the last one. */
+  class ProgressSink {
+  public:
+    explicit ProgressSink( double interval = 0 ) : interval( interval ), last( -1 ) {}
+    virtual ~ProgressSink() {}
+    void offer( const Progress &p );
+
+  protected:
+    virtual void report( const Progress &p ) = 0;
+
+  private:
+    double interval;
+    double last;              // the elapsed time of the previous report
+  };
+
+  struct Network {
+    NetworkType type;
+    Rule rule;
+    int dimension;
+    int epochs;               // total number of epochs required to learn
+    int maxEpochs;
+    bool initialized;
+    std::vector< Module > modules;
+
+    // TopoART
+    int tau;                  // number of learning cycles before the node candidates are removed
+    int tauCounter;           // number of learning cycles since the node candidates were last removed
+
+    // ARTMAP
+    bool simplified;
+    Mapfield mapfield;
+
+    Stats *stats;             // the search counters, recorded if not NULL
+    ProgressSink *progress;   // the epochs of train are reported to it if not NULL
+    Convergence convergence;  // the criteria of the next call of train
+    StopReason stopReason;    // why the last call of train stopped
+
+    Network();
+    ModuleStats *moduleStats( int id ) const { return stats == NULL ? NULL : &stats->modules[id]; }
+    int numModules() const { return modules.size(); }
+    bool hasMoreModules( int id ) const { return id + 1 < numModules(); }
+  };
+
+  /* EpochProgress: times a call of train and offers its epochs to the progress sink of the network */
+  class EpochProgress {
+  public:
+    EpochProgress() : start( std::chrono::steady_clock::now() ) {}
+    void epoch( const Network &net, int epoch, long rows, int changes, StopReason stopReason ) const;
+
+  private:
+    std::chrono::steady_clock::time_point start;
+  };
+
+  /* ConvergenceTest: the convergence criteria of the network, tested after each epoch of train
+     against the counters kept by learning, so no epoch sums over the categories */
+  class ConvergenceTest {
+  public:
+    explicit ConvergenceTest( Network &net );
+    StopReason epoch( Network &net, int epoch, int changes );
+
+  private:
+    std::vector< int > categories;  // the number of categories of each module after the previous epoch
+    int stable;                     // the epochs in a row without new categories
+  };
+
+  /* PartialTrainResult: for each row learned by partialTrain, the category it resonated with in
+     module 0 (module a for ARTMAP), whether that category is new and the time taken in microseconds */
+  struct PartialTrainResult {
+    std::vector< int > category;
+    std::vector< bool > newCategory;
+    std::vector< double > time;
+  };
+
+  /* ShardReport: the result of ART::trainSharded and, with compare, of the serial training of the
+     same rows. The times are in seconds. */
+  struct ShardReport {
+    int shards;
+    int shardCategories;    // the module 0 categories of all the shards, learned by the merge
+    int categories;         // the module 0 categories after the merge
+    double shardTime;       // training the shards
+    double mergeTime;       // merging their categories
+    bool compared;
+    int serialCategories;   // the module 0 categories of serial training
+    double serialTime;
+    double agreement;       // the adjusted Rand index of the module 0 categories of the rows
+  };
+
+  /* CompactReport: the result of compact. With rows, the predictions of module 0 (module a for
+     ARTMAP) before and after it are compared. The times are in seconds. */
+  struct CompactReport {
+    std::vector< int > categories;  // the categories of each module compacted, before
+    std::vector< int > removed;     // the categories removed from each
+    std::vector< std::vector< int > > order;  // for each, the old index of each category kept
+    bool measured;
+    long orphans;                   // the rows whose category was removed
+    long relearned;                 // the orphans learned by a kept category
+    double agreement;               // the fraction of the rows that keep their category
+    bool tested;                    // ARTMAP with a target
+    double accuracyBefore;          // the fraction of the predictions that match the target
+    double accuracyAfter;
+    double timeBefore;              // predicting the rows
+    double timeAfter;
+  };
+
+  // the learning rules
+  namespace fuzzy {
+    double activation( const double *x, const double *w, int n, double alpha );
+    void blockActivation( const double *x, const double *block, int n, double alpha, double *a );
+    double match( const double *x, const double *w, int n );
+    double categoryMatch( const double *v, const double *w, int n );
+    double weightUpdate( const double *x, double *w, int n, double learningRate );
+  }
+
+  namespace hypersphere {
+    double norm( const double *x, const double *m, int n );
+    double activation( const double *x, const double *w, int n, double R_bar, double alpha );
+    void blockActivation( const double *x, const double *block, int n, double R_bar, double alpha, double *a );
+    double match( const double *x, const double *w, int n, double R_bar );
+    double categoryMatch( const double *v, const double *w, int n, double R_bar );
+    double weightUpdate( const double *x, double *w, int n, double learningRate );
+    double categoryUpdate( const double *v, double *w, int n, double learningRate );
+    double R_bar( const std::vector< double > &minimum, const std::vector< double > &maximum );
+  }
+
+  namespace art1 {
+    void newWeight( int n, double L, double *w );
+    double activation( const double *x, const double *w, int n );
+    void blockActivation( const double *x, const double *block, int n, double *a );
+    double match( const double *x, const double *w, int n );
+    double weightUpdate( const double *x, double *w, int n, double L );
+  }
+
+  std::string ruleName( Rule rule );
+  Rule parseRule( const std::string &name );
+  int weightDimension( Rule rule, int dimension );
+  int codeDimension( Rule rule, int dimension );
+  void processCode( Rule rule, const double *x, int dimension, double *code );
+  int unProcessCode( Rule rule, const double *code, int length, double *x );
+  void newWeight( Rule rule, const Module &module, const double *x, double *w );
+  void categoryWeight( Rule rule, const Module &module, const double *v, double *w );
+  /* Kernels: the activation and match functions of a rule for the modules of one weight dimension
+     (see kernels) */
+  struct Kernels {
+    double ( *activation )( const Module &module, const double *x, const double *w );
+    double ( *match )( const Module &module, const double *x, const double *w );
+    void ( *blockActivation )( const Module &module, const double *x, const double *block, double *a );
+  };
+
+  const Kernels &kernels( Rule rule, int weightDimension );
+  double activation( Rule rule, const Module &module, const double *x, const double *w );
+  void blockActivation( Rule rule, const Module &module, const double *x, const double *block, double *a );
+  double match( Rule rule, const Module &module, const double *x, const double *w );
+  void blockBound( Rule rule, const Module &module, const double *x, double sx, int b, double &T, double &m );
+
+  /* Vigilance: the match of one input against the categories of a module during a search. The
+     sums of the input are worked out once. For modules wider than the unrolled kernels, the
+     category is dropped at the end of the first block of values after which it can no longer
+     reach the vigilance (see core-rules.cpp). */
+  class Vigilance {
+  public:
+    Vigilance( Rule rule, const Module &module, const double *x );
+    // match: the match of category w, the same as core::match when it is rho or above, and
+    // -Inf when the category is dropped before
+    double match( const double *w, double rho ) const;
+    // passes: whether the category passes the vigilance test of the module
+    bool passes( const double *w ) const { return match( w, module.rho ) >= module.rho; }
+
+    static const int BLOCK = 16;    // the values summed between the checks
+
+  private:
+    Rule rule;
+    const Module &module;
+    const double *x;
+    const Kernels &f;
+    int n;                          // the values of the input
+    bool early;                     // whether to check the blocks
+    double sx;                      // fuzzy and ART1: the norm of the input
+    double sizeX;                   // fuzzy and ART1: the sum of the absolute values of the input
+    std::vector< double > rest;     // fuzzy and ART1: the positive values left from each block on
+  };
+  double weightUpdate( Rule rule, const Module &module, double learningRate, const double *x, double *w );
+  const double *categoryInput( Rule rule, const Module &module, const double *w );
+  double categoryMatch( Rule rule, const Module &module, const double *v, const double *w );
+  double categoryUpdate( Rule rule, const Module &module, double learningRate, const double *v, double *w );
+
+  // utilities
+  void sortIndex( const std::vector< double > &x, std::vector< int > &idx );
+  void columnRange( Rows x, std::vector< double > &minimum, std::vector< double > &maximum );
+  void startStats( Network &net );
+  std::string stopReasonName( StopReason reason );
+  void initR_bar( Network &net, Rows x );
+  void initR_bar( Network &net, RowSource &source );
+  void initR_bar( Network &net, const std::vector< double > &minimum, const std::vector< double > &maximum );
+  int numThreads( int threads );
+  void parallel( int n, const std::function< void( int ) > &f );
+  std::vector< std::vector< int > > linkClusters( const std::vector< int > &edges, const std::vector< int > &nodes );
+  std::vector< int > clusterIndex( const std::vector< std::vector< int > > &linkedClusters, int numNodes );
+  double adjustedRandIndex( const std::vector< int > &a, const std::vector< int > &b );
+  std::vector< int > categoryUsage( const Network &net, const Module &module );
+  void remapCategories( Network &net, int id, const std::vector< int > &newIndices );
+  CompactReport compact( Network &net, int minCounter, Rows x = Rows(), Rows target = Rows(), bool relearn = false,
+                         bool byUsage = false );
+
+  namespace ART {
+    double rho( double rho, int moduleId );
+    Module module( int id, double vigilance, double learningRate, int categorySize );
+    Network create( Rule rule, int dimension, int num, double vigilance, double learningRate, int categorySize, int maxEpochs );
+
+    void init( Network &net );
+    int moduleChange( const Module &module );
+    int totalChange( const Network &net );
+    void changeReset( Module &module );
+    void counterReset( Module &module );
+    void activation( const Network &net, const Module &module, const double *x, std::vector< double > &a );
+    double weightUpdate( const Network &net, Module &module, int weightIndex, const double *x, double learningRate );
+    void newCategory( const Network &net, Module &module, const double *x );
+    void learn( Network &net, int id, const double *x );
+    int classify( Network &net, int id, const double *x );
+
+    void train( Network &net, Rows x, bool activeSet = false );
+    void train( Network &net, RowSource &source, bool activeSet = false );
+    void trainSpeculative( Network &net, Rows x, int window = 0, int threads = 0 );
+    void trainSpeculative( Network &net, RowSource &source, int window = 0, int threads = 0 );
+    void trainDeferred( Network &net, Rows x, int threads = 0 );
+    void trainDeferred( Network &net, RowSource &source, int threads = 0 );
+    void trainBatch( Network &net, Rows x, int batchSize, int threads = 0 );
+    ShardReport trainSharded( Network &net, Rows x, int shards, int threads = 0, bool compare = false );
+    PartialTrainResult partialTrain( Network &net, Rows x );
+    std::vector< int > predict( Network &net, int id, Rows x );
+
+    /* HierarchyPrediction: the category of each row in each module, searched from the top module
+       down, row by row in path with a value for each module (module 0 first), and whether the
+       search of module 0 fell back to all its categories */
+    struct HierarchyPrediction {
+      std::vector< int > path;
+      int modules;
+      std::vector< int > fallback;
+    };
+
+    HierarchyPrediction predictHierarchy( Network &net, Rows x, int width = 16 );
+  }
+
+  namespace ARTMAP {
+    Network create( Rule rule, int dimension, double vigilance, double learningRate, int categorySize, int maxEpochs, bool simplified );
+
+    void init( Network &net );
+    void train( Network &net, Rows x, Rows target );
+    void train( Network &net, RowSource &source );
+    PartialTrainResult partialTrain( Network &net, Rows x, Rows target );
+
+    /* Prediction: the predicted label (simplified) or the recalled F1b pattern of each row
+       (standard, stored row by row in predicted with predictedDimension values per row), the
+       module a category (-1 if none) and whether the prediction matches the target (0 without a
+       target, -1 if it can't be tested) */
+    struct Prediction {
+      std::vector< double > predicted;
+      int predictedDimension;
+      std::vector< int > category_a;
+      std::vector< int > matched;
+    };
+    Prediction predict( Network &net, Rows x, Rows target );
+  }
+
+  namespace Topo {
+    double rho( double rho, int moduleId );
+    Module module( int id, double vigilance, int phi, double learningRate1, double learningRate2, int categorySize );
+    Network create( Rule rule, int dimension, int num, double vigilance, double learningRate1, double learningRate2,
+                    int tau, int phi, int categorySize, int maxEpochs );
+
+    void init( Network &net );
+    void train( Network &net, Rows x, bool staged = false );
+    void train( Network &net, RowSource &source, bool staged = false );
+    void partialTrain( Network &net, Rows x );
+    void saveEdges( Module &module );
+    void predict( Network &net, int id, Rows x, std::vector< int > &category, std::vector< int > &linkedCluster );
+  }
+
+}
+
+#endif
@@ -0,0 +1,50 @@
+/****************************************************************************
+ *
+ *  data.cpp
+ *  Data files
+ *
+ *  Reads a CSV or binary matrix file straight into an R matrix. The file
+ *  is parsed and normalized by several threads on native buffers (see
+ *  core-io.cpp); only the finished matrix is copied into R.
+ *
+ ****************************************************************************/
+
+#include <Rcpp.h>
+#include "core-io.h"
+#include "native.h"
+using namespace Rcpp;
+
+
+// [[Rcpp::export(.readData)]]
+NumericMatrix readData( std::string file, Nullable< NumericVector > minimum = R_NilValue, Nullable< NumericVector > maximum = R_NilValue,
+                        bool normalize = true, int threads = 0 ){
+  if ( !normalize ){
+    core::Matrix m = core::readData( file );
+    NumericMatrix x = native::toMatrix( m.values, m.rows, m.cols );
+    if ( !m.names.empty() ){
+      colnames( x ) = wrap( m.names );
+    }
+    return x;
+  }
+
+  std::vector< double > min, max;
+  if ( minimum.isNotNull() && maximum.isNotNull() ){
+    min = as< std::vector< double > >( minimum );
+    max = as< std::vector< double > >( maximum );
+  }
+  core::NormalizedData d = core::readNormalized( file, min, max, threads );
+  NumericMatrix x = native::toMatrix( d.values, d.rows, d.cols );
+  if ( !d.names.empty() ){
+    colnames( x ) = wrap( d.names );
+  }
+
+  // the ranges of the columns, as normalize keeps them
+  NumericMatrix ranges( 2, d.cols );
+  for ( int j = 0; j < d.cols; j++ ){
+    ranges( 0, j ) = d.minimum[j];
+    ranges( 1, j ) = d.maximum[j];
+  }
+  rownames( ranges ) = CharacterVector::create( "min", "max" );
+  x.attr( "ranges" ) = ranges;
+  return x;
+}
@@ -22,6 +22,8 @@
 using namespace Rcpp;
 #include "fuzzy.h"
 
+// The learning rule itself is in core-rules.cpp; here are the checks of the R network.
+
 bool isFuzzy ( List net ){
   return as<std::string>( net.attr( "rule" ) ).compare( "fuzzy" ) == 0;
 }
@@ -38,56 +40,3 @@ void checkFuzzyBounds ( List net ){
     }
   }
 }
-
-Fuzzy::Fuzzy( List net ) : IModel( net ){}
-
-int Fuzzy::getWeightDimension( int featureDimension ){
-  return featureDimension * 2;
-}
-
-NumericVector Fuzzy::newWeight( List module, NumericVector w ){
-  return w;
-}
-
-double Fuzzy::activation( List module, NumericVector x, NumericVector w ) {
-  
-  return sum( na_omit( pmin( x, w ) ) )/( ART::getAlpha( module ) + sum( na_omit( w ) ) );
-}
-
-double Fuzzy::TopoPredictActivation ( List module, NumericVector x, NumericVector w ) {
-  
-  double a = 1 - sum( na_omit( pmin( x, w ) - w ) )/ART::getDimension( module );
-  return a;
-}
-
-double Fuzzy::match( List module, NumericVector x, NumericVector w )  {
-  
-  return sum( na_omit( pmin( x, w ) ) )/sum( na_omit( x ) );
-}
-
-NumericVector Fuzzy::weightUpdate( List module, double learningRate, NumericVector x, NumericVector w ) {
-  return learningRate * pmin( x, w ) + ( 1.0 - learningRate ) * w;
-  
-}
-
-NumericVector Fuzzy::getNextLayerInput( NumericVector w ){ return w ; }
-
-// processCode: Create complement code
-NumericVector Fuzzy::processCode( NumericVector x )  {
-  int s = x.size();
-  NumericVector c( s*2 );
-  for ( int i = 0; i < s; i++ ){
-    c[i] = x[i];
-    c[i+s] = 1 - x[i];
-  }
-  return c;
-}
-
-NumericVector Fuzzy::unProcessCode( NumericVector x ){
-  int l = x.length();
-  // the length must be even
-  if ( l % 2 != 0 )
-    stop( "The length of the code must be an even number." );
-  return x[ Range( 0, l/2 - 1 ) ];
-}
-
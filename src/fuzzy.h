@@ -6,7 +6,6 @@
  ****************************************************************************/
 
 #include <Rcpp.h>
-#include "IModel.h"
 using namespace Rcpp;
 
 #ifndef FUZZY_H
@@ -15,19 +14,4 @@ using namespace Rcpp;
 bool isFuzzy ( List net );
 void checkFuzzyBounds ( List net );
 
-struct Fuzzy : IModel {
-  
-  Fuzzy( List net );
-  int getWeightDimension( int featureDimension );
-  NumericVector newWeight( List module, NumericVector w );
-  double activation( List module, NumericVector x, NumericVector w );
-  double TopoPredictActivation (List module, NumericVector x, NumericVector w );
-  double match(List module, NumericVector x, NumericVector w );
-  NumericVector weightUpdate( List module, double learningRate, NumericVector x, NumericVector w );
-  NumericVector getNextLayerInput( NumericVector w );
-  NumericVector processCode( NumericVector x );
-  NumericVector unProcessCode( NumericVector x );
-  NumericMatrix normalizeCode( NumericMatrix x );
-};
-
 #endif
\ No newline at end of file
@@ -0,0 +1,503 @@
+/****************************************************************************
+ *
+ *  native.cpp
+ *  Conversion between the R networks and the native network state
+ *
+ *  The R network is read once into core::Network before a training or
+ *  prediction run, and the learned state is written back into the same R
+ *  list afterwards. partialTrain instead keeps the native state in the R
+ *  network between calls and writes back only what it learned. The engine
+ *  itself never touches an R object.
+ *
+ ****************************************************************************/
+
+#include <Rcpp.h>
+#include <cmath>
+#include "ART.h"
+#include "core-progress.h"
+#include "native.h"
+using namespace Rcpp;
+
+
+namespace native {
+
+  namespace {
+
+    std::vector< int > toVector( SEXP x ){
+      IntegerVector v( x );
+      return std::vector< int >( v.begin(), v.end() );
+    }
+
+    // readWeights: the weight matrix of a module or standard map field, row-major
+    std::vector< double > readWeights( NumericMatrix w ){
+      if ( w.nrow() == 0 || w.ncol() == 0 ){
+        return std::vector< double >();
+      }
+      return rowMajor( w );
+    }
+
+    core::Module toModule( List module, core::NetworkType type ){
+      core::Module m;
+      m.id = module["id"];
+      m.weightDimension = module["weightDimension"];
+      m.capacity = module["capacity"];
+      m.numCategories = module["numCategories"];
+      m.alpha = module["alpha"];
+      m.epsilon = module["epsilon"];
+      m.rho = module["rho"];
+      m.beta = module["beta"];
+
+      NumericMatrix w = module["w"];
+      m.w = readWeights( w );
+      m.rows = m.w.empty() ? 0 : w.nrow();
+      m.counter = toVector( module["counter"] );
+      m.change = toVector( module["change"] );
+      m.Jmax = toVector( module["Jmax"] );
+      m.counter.resize( m.rows, 0 );
+      m.change.resize( m.rows, 0 );
+
+      if ( module.containsElementNamed( "R_bar" ) ){
+        m.R_bar = module["R_bar"];
+        m.hasR_bar = true;
+      }
+
+      if ( type == core::NETWORK_TOPOART ){
+        m.beta1 = module["beta1"];
+        m.beta2 = module["beta2"];
+        m.phi = module["phi"];
+        m.n = toVector( module["n"] );
+        m.edges.assign( toVector( module["edge"] ) );
+        List linkedClusters = module["linkedClusters"];
+        for ( int i = 0; i < linkedClusters.length(); i++ ){
+          m.linkedClusters.push_back( toVector( linkedClusters[i] ) );
+        }
+      }
+      m.n.resize( m.rows, 0 );
+
+      return m;
+    }
+
+    // writeRows: write the rows of a row-major matrix into the R matrix w, in place
+    void writeRows( NumericMatrix w, const double *x, int ncol, const std::vector< int > &rows ){
+      for ( int i : rows ){
+        if ( i < w.nrow() ){
+          for ( int j = 0; j < ncol; j++ ){
+            double v = x[(size_t)i * ncol + j];
+            w( i, j ) = std::isnan( v ) ? NA_REAL : v;
+          }
+        }
+      }
+    }
+
+    // updateWeights: write the weights of a module into the R module. If the R matrix is written,
+    // the one partialTrain last read or wrote, and has the shape of the storage, only the
+    // categories logged since are written into it in place; otherwise it is replaced, keeping
+    // its column names.
+    void updateWeights( const core::Module &m, List module, SEXP written ){
+      NumericMatrix w = module["w"];
+      bool same = w.nrow() == m.rows && w.ncol() == m.weightDimension;
+      if ( written != R_NilValue && (SEXP)w == written && same && !m.writes.all ){
+        writeRows( w, m.w.data(), m.weightDimension, m.writes.categories );
+        return;
+      }
+      NumericMatrix replaced = toMatrix( m.w.data(), m.rows, m.weightDimension );
+      if ( w.ncol() == m.weightDimension ){
+        SEXP names = colnames( w );
+        if ( !Rf_isNull( names ) ){
+          colnames( replaced ) = names;
+        }
+      }
+      module["w"] = replaced;
+    }
+
+    void updateModule( const core::Module &m, List module, core::NetworkType type, SEXP written = R_NilValue ){
+      module["weightDimension"] = m.weightDimension;
+      module["numCategories"] = m.numCategories;
+      updateWeights( m, module, written );
+      module["counter"] = IntegerVector( m.counter.begin(), m.counter.begin() + m.rows );
+      module["change"] = IntegerVector( m.change.begin(), m.change.begin() + m.rows );
+      module["Jmax"] = IntegerVector( m.Jmax.begin(), m.Jmax.end() );
+
+      if ( type == core::NETWORK_TOPOART ){
+        module["n"] = IntegerVector( m.n.begin(), m.n.begin() + m.rows );
+        const std::vector< int > &e = m.edges.nodes;
+        IntegerVector edge( e.begin(), e.end() );
+        if ( !e.empty() ){
+          // a 2 x n matrix of the linked node pairs
+          edge.attr( "dim" ) = Dimension( 2, e.size()/2 );
+        }
+        module["edge"] = edge;
+        List linkedClusters( m.linkedClusters.size() );
+        for ( size_t i = 0; i < m.linkedClusters.size(); i++ ){
+          linkedClusters[i] = wrap( m.linkedClusters[i] );
+        }
+        module["linkedClusters"] = linkedClusters;
+      }
+    }
+
+    void toMapfield( List mapfield, core::Network &net ){
+      core::Mapfield &m = net.mapfield;
+      m.id = mapfield["id"];
+      m.weightDimension = mapfield["weightDimension"];
+      m.capacity = mapfield["capacity"];
+      m.alpha = mapfield["alpha"];
+      m.epsilon = mapfield["epsilon"];
+      m.rho = mapfield["rho"];
+      m.beta = mapfield["beta"];
+      m.change = toVector( mapfield["change"] );
+      if ( net.simplified ){
+        m.label = toVector( mapfield["w"] );
+        m.numCategories = mapfield["numCategories"];
+        m.change.resize( m.label.size(), 0 );
+      }
+      else{
+        NumericMatrix w = mapfield["w"];
+        m.w = readWeights( w );
+        m.rows = m.w.empty() ? 0 : w.nrow();
+        m.cols = m.w.empty() ? 0 : w.ncol();
+        m.numCategories_a = mapfield["numCategories_a"];
+        m.numCategories_b = mapfield["numCategories_b"];
+        m.change.resize( m.rows, 0 );
+      }
+    }
+
+    // updateMapfield: as updateWeights, the standard map field is written in place when its R
+    // matrix is still written; its rows change with the module a categories logged
+    void updateMapfield( const core::Network &net, List mapfield, SEXP written = R_NilValue ){
+      const core::Mapfield &m = net.mapfield;
+      mapfield["weightDimension"] = m.weightDimension;
+      mapfield["change"] = IntegerVector( m.change.begin(), m.change.end() );
+      if ( net.simplified ){
+        mapfield["w"] = IntegerVector( m.label.begin(), m.label.end() );
+        mapfield["numCategories"] = m.numCategories;
+      }
+      else{
+        NumericMatrix w = mapfield["w"];
+        const core::CategoryLog &a = net.modules[0].writes;
+        if ( written != R_NilValue && (SEXP)w == written && w.nrow() == m.rows && w.ncol() == m.cols && !a.all ){
+          writeRows( w, m.w.data(), m.cols, a.categories );
+        }
+        else{
+          mapfield["w"] = toMatrix( m.w, m.rows, m.cols );
+        }
+        mapfield["numCategories_a"] = m.numCategories_a;
+        mapfield["numCategories_b"] = m.numCategories_b;
+      }
+    }
+  }
+
+  core::Rule getRule( List net ){
+    // the TopoART constructor in R keeps the whole choice vector, so use the first element
+    CharacterVector rule = net.attr( "rule" );
+    return core::parseRule( as<std::string>( rule[0] ) );
+  }
+
+  core::Network toNetwork( List net ){
+    core::Network state;
+    std::string type = as<std::string>( net.attr( "class" ) );
+    if ( type == "ARTMAP" ){
+      state.type = core::NETWORK_ARTMAP;
+      state.simplified = as<bool>( net.attr( "simplified" ) );
+    }
+    else if ( type == "TopoART" ){
+      state.type = core::NETWORK_TOPOART;
+      state.tau = net["tau"];
+      state.tauCounter = net.containsElementNamed( "tauCounter" ) ? as<int>( net["tauCounter"] ) : 0;
+    }
+    else{
+      state.type = core::NETWORK_ART;
+    }
+    state.rule = getRule( net );
+    state.dimension = net["dimension"];
+    state.epochs = net["epochs"];
+    state.maxEpochs = net["maxEpochs"];
+    state.initialized = ART::isInitialized( net );
+
+    int numModules = ART::getNumModules( net );
+    for ( int i = 0; i < numModules; i++ ){
+      state.modules.push_back( toModule( ART::getModule( net, i ), state.type ) );
+    }
+    if ( state.type == core::NETWORK_ARTMAP ){
+      toMapfield( net["mapfield"], state );
+    }
+    return state;
+  }
+
+  namespace {
+
+    /* NetworkCache: the native state of an R network kept between the calls of partialTrain
+       behind an external pointer, the "native" attribute of the network, with the R vectors it
+       was read from or last written to (see learnedVectors). The pointer protects those vectors,
+       so R copies them before changing them and a changed vector shows that the network must be
+       read again. The weights are written back in place, so a copy of a weight matrix taken in R
+       between the calls changes with it, as the module lists already do. */
+    struct NetworkCache {
+      core::Network state;
+      std::vector< SEXP > written;
+    };
+
+    // learnedVectors: the vectors of the R network that learning reads besides the scalars: the
+    // weights of each module and of the standard map field first, then the counters and, for
+    // TopoART, the accumulators and the edges
+    std::vector< SEXP > learnedVectors( List net, const core::Network &state ){
+      std::vector< SEXP > v;
+      int numModules = state.numModules();
+      for ( int i = 0; i < numModules; i++ ){
+        SEXP w = ART::getModule( net, i )["w"];
+        v.push_back( w );
+      }
+      if ( state.type == core::NETWORK_ARTMAP ){
+        SEXP w = as< List >( net["mapfield"] )["w"];
+        v.push_back( w );
+      }
+      for ( int i = 0; i < numModules; i++ ){
+        List module = ART::getModule( net, i );
+        SEXP counter = module["counter"];
+        v.push_back( counter );
+        if ( state.type == core::NETWORK_TOPOART ){
+          SEXP n = module["n"];
+          SEXP edge = module["edge"];
+          v.push_back( n );
+          v.push_back( edge );
+        }
+      }
+      return v;
+    }
+
+    // current: whether the R network is still the one the cache was read from or last written to
+    bool current( const NetworkCache &cache, List net ){
+      const core::Network &s = cache.state;
+      if ( ART::getNumModules( net ) != s.numModules() || as< int >( net["dimension"] ) != s.dimension ||
+           as< int >( net["epochs"] ) != s.epochs || ART::isInitialized( net ) != s.initialized ||
+           getRule( net ) != s.rule ){
+        return false;
+      }
+      if ( s.type == core::NETWORK_TOPOART && ( as< int >( net["tau"] ) != s.tau ||
+           ( net.containsElementNamed( "tauCounter" ) && as< int >( net["tauCounter"] ) != s.tauCounter ) ) ){
+        return false;
+      }
+      for ( const core::Module &m : s.modules ){
+        List module = ART::getModule( net, m.id );
+        if ( as< int >( module["numCategories"] ) != m.numCategories || as< int >( module["capacity"] ) != m.capacity ||
+             as< double >( module["rho"] ) != m.rho || as< double >( module["beta"] ) != m.beta ||
+             as< double >( module["alpha"] ) != m.alpha || as< double >( module["epsilon"] ) != m.epsilon ){
+          return false;
+        }
+        if ( s.type == core::NETWORK_TOPOART && ( as< double >( module["beta1"] ) != m.beta1 ||
+             as< double >( module["beta2"] ) != m.beta2 || as< int >( module["phi"] ) != m.phi ) ){
+          return false;
+        }
+      }
+      if ( s.type == core::NETWORK_ARTMAP ){
+        List mapfield = net["mapfield"];
+        const core::Mapfield &m = s.mapfield;
+        if ( as< double >( mapfield["rho"] ) != m.rho || as< double >( mapfield["beta"] ) != m.beta ){
+          return false;
+        }
+        if ( s.simplified ? as< int >( mapfield["numCategories"] ) != m.numCategories
+                          : as< int >( mapfield["numCategories_a"] ) != m.numCategories_a ||
+                            as< int >( mapfield["numCategories_b"] ) != m.numCategories_b ){
+          return false;
+        }
+      }
+      return learnedVectors( net, s ) == cache.written;
+    }
+
+    // remember: record the vectors of the R network in the cache and protect them
+    void remember( XPtr< NetworkCache > cache, List net ){
+      cache->written = learnedVectors( net, cache->state );
+      List written( cache->written.size() );
+      for ( size_t i = 0; i < cache->written.size(); i++ ){
+        written[i] = cache->written[i];
+      }
+      R_SetExternalPtrProtected( cache, written );
+    }
+
+    // writeNetwork: write the native state into the R network; written holds the R vectors the
+    // weights can be written into in place, none if it is empty
+    void writeNetwork( const core::Network &state, List net, const std::vector< SEXP > &written ){
+      net["epochs"] = state.epochs;
+      net["init"] = state.initialized ? 1 : 0;
+      if ( state.type == core::NETWORK_TOPOART && net.containsElementNamed( "tauCounter" ) ){
+        net["tauCounter"] = state.tauCounter;
+      }
+
+      for ( const core::Module &m : state.modules ){
+        List module = ART::getModule( net, m.id );
+        if ( m.hasR_bar && !module.containsElementNamed( "R_bar" ) ){
+          // adding an element makes a new list, so put it back into the network
+          module.push_back( m.R_bar, "R_bar" );
+          ART::setModule( net, module );
+        }
+        updateModule( m, module, state.type, written.empty() ? R_NilValue : written[m.id] );
+      }
+      if ( state.type == core::NETWORK_ARTMAP ){
+        updateMapfield( state, net["mapfield"], written.empty() ? R_NilValue : written[state.numModules()] );
+      }
+    }
+
+  }
+
+  void updateNetwork( const core::Network &state, List net ){
+    // the native state kept by partialTrain, if any, is now out of date
+    dropNetwork( net );
+    writeNetwork( state, net, std::vector< SEXP >() );
+  }
+
+  core::Network &cachedNetwork( List net ){
+    SEXP attribute = net.attr( "native" );
+    if ( TYPEOF( attribute ) == EXTPTRSXP ){
+      // the address is NULL in a network restored by readRDS
+      XPtr< NetworkCache > cache( attribute );
+      if ( cache.get() != NULL && current( *cache, net ) ){
+        return cache->state;
+      }
+    }
+    XPtr< NetworkCache > cache( new NetworkCache() );
+    cache->state = toNetwork( net );
+    for ( core::Module &m : cache->state.modules ){
+      m.writes.on = true;
+    }
+    remember( cache, net );
+    net.attr( "native" ) = cache;
+    return cache->state;
+  }
+
+  void syncNetwork( List net ){
+    SEXP attribute = net.attr( "native" );
+    XPtr< NetworkCache > cache( attribute );
+    writeNetwork( cache->state, net, cache->written );
+    for ( core::Module &m : cache->state.modules ){
+      m.writes.clear();
+    }
+    remember( cache, net );
+  }
+
+  void dropNetwork( List net ){
+    net.attr( "native" ) = R_NilValue;
+  }
+
+  std::vector< double > rowMajor( NumericMatrix x ){
+    int nrow = x.nrow();
+    int ncol = x.ncol();
+    std::vector< double > v( (size_t)nrow * ncol );
+    for ( int j = 0; j < ncol; j++ ){
+      const double *c = REAL( x ) + (size_t)j * nrow;
+      for ( int i = 0; i < nrow; i++ ){
+        v[(size_t)i * ncol + j] = c[i];
+      }
+    }
+    return v;
+  }
+
+  NumericMatrix toMatrix( const std::vector< double > &x, int nrow, int ncol ){
+    return toMatrix( x.data(), nrow, ncol );
+  }
+
+  NumericMatrix toMatrix( const double *x, int nrow, int ncol ){
+    NumericMatrix m = no_init( nrow, ncol );
+    for ( int i = 0; i < nrow; i++ ){
+      for ( int j = 0; j < ncol; j++ ){
+        double v = x[(size_t)i * ncol + j];
+        m( i, j ) = std::isnan( v ) ? NA_REAL : v;
+      }
+    }
+    return m;
+  }
+
+  IntegerVector toRVector( const std::vector< int > &x ){
+    IntegerVector v( x.size() );
+    for ( size_t i = 0; i < x.size(); i++ ){
+      v[i] = x[i] == -1 ? NA_INTEGER : x[i];
+    }
+    return v;
+  }
+
+  List toList( const core::Stats &stats ){
+    List modules( stats.modules.size() );
+    for ( size_t i = 0; i < stats.modules.size(); i++ ){
+      const core::ModuleStats &s = stats.modules[i];
+      // depth[d + 1] is the number of searches that examined d candidates
+      modules[i] = List::create( _["id"] = (int)i,
+                                 _["searches"] = (double)s.searches,
+                                 _["depth"] = NumericVector( s.depth.begin(), s.depth.end() ),
+                                 _["vigilanceFailures"] = (double)s.vigilanceFailures,
+                                 _["matchTrackingResets"] = (double)s.matchTrackingResets,
+                                 _["newCategories"] = (double)s.newCategories,
+                                 _["removals"] = (double)s.removals,
+                                 _["blocksVisited"] = (double)s.blocksVisited,
+                                 _["blocksMatchPruned"] = (double)s.blocksMatchPruned,
+                                 _["blocksActivationPruned"] = (double)s.blocksActivationPruned,
+                                 _["activationTime"] = s.activationTime,
+                                 _["searchTime"] = s.searchTime,
+                                 _["updateTime"] = s.updateTime );
+    }
+    return List::create( _["rows"] = (double)stats.rows, _["time"] = stats.time, _["modules"] = modules );
+  }
+
+  namespace {
+
+    /* CallbackSink: calls an R function with each report as a list. train runs on the R
+       thread, so the function is called from the training loop itself. */
+    class CallbackSink : public core::ProgressSink {
+    public:
+      CallbackSink( Function f, double interval ) : core::ProgressSink( interval ), f( f ) {}
+
+    protected:
+      void report( const core::Progress &p ){
+        f( List::create( _["epoch"] = p.epoch,
+                         _["maxEpochs"] = p.maxEpochs,
+                         _["changes"] = p.changes,
+                         _["moduleChanges"] = IntegerVector( p.moduleChanges.begin(), p.moduleChanges.end() ),
+                         _["categories"] = IntegerVector( p.categories.begin(), p.categories.end() ),
+                         _["rows"] = (double)p.rows,
+                         _["elapsed"] = p.elapsed,
+                         _["rowsPerSecond"] = p.rowsPerSecond,
+                         _["done"] = p.done,
+                         _["stopReason"] = p.done ? core::stopReasonName( p.stopReason ) : std::string() ) );
+      }
+
+    private:
+      Function f;
+    };
+
+  }
+
+  // toConvergence: the convergence criteria from a list made by convergence() in R
+  core::Convergence toConvergence( Nullable< List > criteria ){
+    core::Convergence c;
+    if ( criteria.isNotNull() ){
+      List l( criteria );
+      c.changedFraction = l["changedFraction"];
+      c.weightDelta = l["weightDelta"];
+      c.stableEpochs = l["stableEpochs"];
+    }
+    return c;
+  }
+
+  // trainResult: what the train functions return besides the network
+  List trainResult( const core::Network &state, const core::Stats *stats ){
+    return List::create( _["stats"] = stats != NULL ? RObject( toList( *stats ) ) : RObject(),
+                         _["stopReason"] = core::stopReasonName( state.stopReason ) );
+  }
+
+  // progressSink: a function is called with each report, and a file name gets the reports as
+  // JSON lines
+  std::unique_ptr< core::ProgressSink > progressSink( RObject progress, double interval ){
+    std::unique_ptr< core::ProgressSink > sink;
+    if ( Rf_isNull( progress ) ){
+      return sink;
+    }
+    if ( Rf_isFunction( progress ) ){
+      sink.reset( new CallbackSink( Function( (SEXP)progress ), interval ) );
+    }
+    else if ( Rf_isString( progress ) && Rf_length( progress ) == 1 ){
+      sink.reset( new core::JSONLinesSink( as< std::string >( progress ), interval ) );
+    }
+    else{
+      stop( "progress must be NULL, a function or the name of a file." );
+    }
+    return sink;
+  }
+
+}
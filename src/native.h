@@ -0,0 +1,60 @@
+/****************************************************************************
+ *
+ *  native.h
+ *  Conversion between the R networks and the native network state
+ *
+ ****************************************************************************/
+
+#include <Rcpp.h>
+#include <memory>
+#include "core.h"
+using namespace Rcpp;
+
+#ifndef NATIVE_H
+#define NATIVE_H
+
+namespace native {
+
+  // getRule: the learning rule of an R network
+  core::Rule getRule( List net );
+
+  // toNetwork: copy an R network into native state
+  core::Network toNetwork( List net );
+
+  // updateNetwork: copy the native state back into the R network, in place
+  void updateNetwork( const core::Network &state, List net );
+
+  // cachedNetwork: the native state kept in the R network between the calls of partialTrain, read
+  // from the network on the first call or when the network was changed since the last call
+  core::Network &cachedNetwork( List net );
+
+  // syncNetwork: write the categories learned since the last call back into the R network, in place
+  void syncNetwork( List net );
+
+  // dropNetwork: forget the native state kept in the R network, e.g. when learning failed
+  void dropNetwork( List net );
+
+  // rowMajor: a row-major copy of an R matrix, to be viewed with core::Rows
+  std::vector< double > rowMajor( NumericMatrix x );
+
+  // toMatrix: an R matrix from a row-major matrix
+  NumericMatrix toMatrix( const std::vector< double > &x, int nrow, int ncol );
+  NumericMatrix toMatrix( const double *x, int nrow, int ncol );
+
+  // toRVector: the category indices with -1 (no category) as NA
+  IntegerVector toRVector( const std::vector< int > &x );
+
+  // toList: the search counters as an R list, with a list of counters for each module
+  List toList( const core::Stats &stats );
+
+  // toConvergence: the convergence criteria from a list made by convergence() in R, the defaults for NULL
+  core::Convergence toConvergence( Nullable< List > criteria );
+
+  // trainResult: the search counters (NULL if they are not recorded) and the stop reason of train
+  List trainResult( const core::Network &state, const core::Stats *stats );
+
+  // progressSink: the sink for the progress argument of the train functions, NULL for none
+  std::unique_ptr< core::ProgressSink > progressSink( RObject progress, double interval );
+}
+
+#endif
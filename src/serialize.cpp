@@ -0,0 +1,192 @@
+/****************************************************************************
+ *
+ *  serialize.cpp
+ *  Binary model files
+ *
+ *  Saves an ART, ARTMAP or TopoART network to a compact binary file and
+ *  loads it back. The loader maps the file into memory and copies each
+ *  data block straight into its R vector, without parsing. The numeric
+ *  matrices are stored row by row, the layout of the native weights, so they
+ *  are transposed on the way. The file format itself is written and checked
+ *  by core-model.cpp.
+ *
+ ****************************************************************************/
+
+#include <Rcpp.h>
+#include <cstring>
+#include "native.h"
+#include "serialize.h"
+using namespace Rcpp;
+using namespace core;
+
+
+namespace {
+
+  // addRecord: add x and, depth-first, its elements and attributes. The data of the numeric
+  // vectors is borrowed from R, so the network must outlive the writer; numeric matrices are
+  // transposed to row-major copies.
+  void addRecord( SEXP x, std::string name, int parent, bool attribute, ModelWriter &writer ){
+    
+    int length = Rf_length( x );
+    int index;
+    switch ( TYPEOF( x ) ){
+      case NILSXP:
+        index = writer.add( RECORD_NULL, name, parent, attribute, length );
+        break;
+      case VECSXP:
+        index = writer.add( RECORD_LIST, name, parent, attribute, length );
+        break;
+      case INTSXP:
+        index = writer.add( RECORD_INTEGER, name, parent, attribute, length, INTEGER( x ), length * sizeof( int ) );
+        break;
+      case REALSXP:
+        if ( Rf_isMatrix( x ) ){
+          std::vector< double > rows = native::rowMajor( x );
+          index = writer.addOwned( RECORD_DOUBLE, name, parent, attribute, length,
+                                   std::string( reinterpret_cast< const char * >( rows.data() ), length * sizeof( double ) ) );
+        }
+        else{
+          index = writer.add( RECORD_DOUBLE, name, parent, attribute, length, REAL( x ), length * sizeof( double ) );
+        }
+        break;
+      case LGLSXP:
+        index = writer.add( RECORD_LOGICAL, name, parent, attribute, length, LOGICAL( x ), length * sizeof( int ) );
+        break;
+      case STRSXP: {
+        std::string owned;
+        for ( int i = 0; i < length; i++ ){
+          SEXP c = STRING_ELT( x, i );
+          if ( c == NA_STRING ){
+            owned.push_back( '\xff' );
+          }
+          else{
+            owned.append( CHAR( c ) );
+          }
+          owned.push_back( '\0' );
+        }
+        index = writer.addOwned( RECORD_STRING, name, parent, attribute, length, owned );
+        break;
+      }
+      default:
+        stop( "The network contains an object that can't be saved in a model file." );
+    }
+    
+    SEXP dim = Rf_getAttrib( x, R_DimSymbol );
+    if ( !Rf_isNull( dim ) && Rf_length( dim ) == 2 ){
+      writer.setMatrix( index, INTEGER( dim )[0], INTEGER( dim )[1], TYPEOF( x ) == REALSXP );
+    }
+    
+    if ( TYPEOF( x ) == VECSXP ){
+      for ( int i = 0; i < length; i++ ){
+        addRecord( VECTOR_ELT( x, i ), "", index, false, writer );
+      }
+    }
+    
+    if ( TYPEOF( x ) != NILSXP ){
+      std::vector< std::string > names = RObject( x ).attributeNames();
+      for ( std::string &n : names ){
+        // the native state kept by partialTrain is rebuilt from the network when it is needed
+        if ( n != "dim" && n != "native" ){
+          addRecord( Rf_getAttrib( x, Rf_install( n.c_str() ) ), n, index, true, writer );
+        }
+      }
+    }
+  }
+  
+  RObject buildRecord( const ModelFile &f, int index ){
+    
+    const ModelRecord &r = *f.records[index];
+    const char *data = f.data( index );
+    int n = r.length;
+    RObject x;
+    
+    switch ( r.type ){
+      case RECORD_NULL:
+        x = R_NilValue;
+        break;
+      case RECORD_LIST: {
+        List l( n );
+        int k = 0;
+        for ( int c : f.elements( index ) ){
+          if ( k < n ){
+            l[k++] = buildRecord( f, c );
+          }
+        }
+        x = l;
+        break;
+      }
+      case RECORD_INTEGER: {
+        IntegerVector v( n );
+        std::memcpy( INTEGER( v ), data, r.bytes );
+        x = v;
+        break;
+      }
+      case RECORD_DOUBLE: {
+        NumericVector v( n );
+        if ( ( r.flags & RECORD_MATRIX ) && ( r.flags & RECORD_ROW_MAJOR ) ){
+          const double *p = reinterpret_cast< const double * >( data );
+          for ( int i = 0; i < r.nrow; i++ ){
+            for ( int j = 0; j < r.ncol; j++ ){
+              v[(size_t)j * r.nrow + i] = p[(size_t)i * r.ncol + j];
+            }
+          }
+        }
+        else{
+          std::memcpy( REAL( v ), data, r.bytes );
+        }
+        x = v;
+        break;
+      }
+      case RECORD_LOGICAL: {
+        LogicalVector v( n );
+        std::memcpy( LOGICAL( v ), data, r.bytes );
+        x = v;
+        break;
+      }
+      case RECORD_STRING: {
+        CharacterVector v( n );
+        const char *p = data;
+        const char *end = data + r.bytes;
+        for ( int i = 0; i < n && p < end; i++ ){
+          size_t l = strnlen( p, end - p );
+          if ( l == 1 && *p == '\xff' ){
+            v[i] = NA_STRING;
+          }
+          else{
+            v[i] = std::string( p, l );
+          }
+          p += l + 1;
+        }
+        x = v;
+        break;
+      }
+      default:
+        stop( "The model file contains an unknown record type." );
+    }
+    
+    if ( r.flags & RECORD_MATRIX ){
+      x.attr( "dim" ) = Dimension( r.nrow, r.ncol );
+    }
+    
+    for ( int c : f.children[index] ){
+      if ( f.isAttribute( c ) ){
+        x.attr( f.records[c]->name ) = buildRecord( f, c );
+      }
+    }
+    
+    return x;
+  }
+}
+
+// [[Rcpp::export(.saveModel)]]
+void saveModel ( List net, std::string file ){
+  ModelWriter writer;
+  addRecord( net, "", -1, false, writer );
+  writer.write( file );
+}
+
+// [[Rcpp::export(.loadModel)]]
+List loadModel ( std::string file ){
+  ModelFile f( file );
+  return as<List>( buildRecord( f, 0 ) );
+}
@@ -0,0 +1,18 @@
+/****************************************************************************
+ *
+ *  serialize.h
+ *  Binary model files
+ *
+ ****************************************************************************/
+
+#include <Rcpp.h>
+#include "core-model.h"
+using namespace Rcpp;
+
+#ifndef SERIALIZE_H
+#define SERIALIZE_H
+
+void saveModel ( List net, std::string file );
+List loadModel ( std::string file );
+
+#endif
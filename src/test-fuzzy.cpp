@@ -1,49 +1,138 @@
 #include <testthat.h>
-#include "fuzzy.h"
-#include "utils.h"
+#include <cmath>
+#include "core.h"
 
 context("fuzzy") {
   test_that("activation") {
-    Fuzzy *f = new Fuzzy( List::create( 0 ) );
-    List module = List::create( _["alpha"] = 2 );
-    NumericVector x = NumericVector::create( 1,2,3 );
-    NumericVector w = NumericVector::create( 3,2,1 );
-    double a = f->activation( module, x, w );
+    double alpha = 2;
+    double x[] = { 1,2,3 };
+    double w[] = { 3,2,1 };
+    double a = core::fuzzy::activation( x, w, 3, alpha );
     expect_true( a == 0.5 );
     
-    x = NumericVector::create(1,2,NA_REAL);
-    a = f->activation( module, x , w );
+    x[2] = NAN;
+    a = core::fuzzy::activation( x, w, 3, alpha );
     expect_true( a == 0.375 );
     
-    x = NumericVector::create( 1,2,3 );
-    w = NumericVector::create( NA_REAL,2,1 );
-    a = f->activation( module, x, w );
+    x[2] = 3;
+    w[0] = NAN;
+    a = core::fuzzy::activation( x, w, 3, alpha );
     expect_true( a == 0.6 );
   }
   
   test_that("match") {
-    Fuzzy *f = new Fuzzy( List::create( 0 ) );
-    List module = List::create( _["alpha"] = 2 );
-    NumericVector x = NumericVector::create( 1,2,3 );
-    NumericVector w = NumericVector::create( 3,2,0 );
-    double m = f->match( module, x, w );
+    double x[] = { 1,2,3 };
+    double w[] = { 3,2,0 };
+    double m = core::fuzzy::match( x, w, 3 );
     expect_true( m == 0.5 );
     
-    x = NumericVector::create( NA_REAL,2,3 );
-    m = f->match( module, x, w );
+    x[0] = NAN;
+    m = core::fuzzy::match( x, w, 3 );
     expect_true( m == 0.4 );
   }
   
+  test_that("blockActivation") {
+    const int L = core::CategoryBlocks::LANES;
+    double alpha = 0.001;
+    double x[] = { 0.2,NAN,0.5 };
+    double w[L][3];
+    double block[3 * L];
+    for ( int k = 0; k < L; k++ ){
+      for ( int i = 0; i < 3; i++ ){
+        w[k][i] = ( k + 1 ) * ( i + 2 ) % 7 / 7.0;
+      }
+    }
+    w[3][0] = NAN;
+    for ( int k = 0; k < L; k++ ){
+      for ( int i = 0; i < 3; i++ ){
+        block[i * L + k] = w[k][i];
+      }
+    }
+    double a[L];
+    core::fuzzy::blockActivation( x, block, 3, alpha, a );
+    for ( int k = 0; k < L; k++ ){
+      expect_true( a[k] == core::fuzzy::activation( x, w[k], 3, alpha ) );
+    }
+  }
+
+  test_that("Vigilance") {
+    const int n = 80;
+    core::Module module;
+    module.init( n );
+    module.rho = 0.9;
+    double x[n];
+    double w[n];
+    for ( int i = 0; i < n; i++ ){
+      x[i] = ( i * 7 % 11 )/11.0;
+    }
+    x[5] = NAN;
+    core::Vigilance vigilance( core::RULE_FUZZY, module, x );
+    for ( int k = 0; k < 20; k++ ){
+      for ( int i = 0; i < n; i++ ){
+        w[i] = i < k * 4 ? x[i]/2 : x[i];
+      }
+      double m = core::match( core::RULE_FUZZY, module, x, w );
+      double early = vigilance.match( w, module.rho );
+      expect_true( m >= module.rho ? early == m : early < module.rho );
+    }
+  }
+
+  test_that("blockBound") {
+    const int n = 6;
+    const int nc = 100;
+    core::Module module;
+    module.capacity = nc;
+    module.init( n );
+    double x[] = { 0.3,0.8,NAN,0.7,0.2,0.5 };
+    double sx = 0.3 + 0.8 + 0.7 + 0.2 + 0.5;
+    for ( int k = 0; k < nc; k++ ){
+      for ( int i = 0; i < n; i++ ){
+        module.weight( k )[i] = ( k * ( i + 3 ) % 13 )/13.0;
+      }
+    }
+    module.numCategories = nc;
+    module.syncEnvelopes( core::RULE_FUZZY );
+    for ( int k = 0; k < nc; k++ ){
+      double T, m;
+      core::blockBound( core::RULE_FUZZY, module, x, sx, k/core::CategoryEnvelopes::SIZE, T, m );
+      expect_true( T >= core::activation( core::RULE_FUZZY, module, x, module.weight( k ) ) );
+      expect_true( m >= core::match( core::RULE_FUZZY, module, x, module.weight( k ) ) );
+    }
+  }
+
+  test_that("blockBound prunes by activation") {
+    // the blocks 1 to 3 match x fully but have larger weights than block 0, which holds x
+    core::Network net = core::ART::create( core::RULE_FUZZY, 1, 1, 0.9, 1.0, 256, 1 );
+    core::ART::init( net );
+    core::Module &module = net.modules[0];
+    const int S = core::CategoryEnvelopes::SIZE;
+    for ( int k = 0; k < 4 * S; k++ ){
+      module.weight( k )[0] = 0.5;
+      module.weight( k )[1] = k < S ? 0.5 : 1.0;
+    }
+    module.numCategories = 4 * S;
+    module.clearBlocks();
+    double x[] = { 0.5,0.5 };
+    module.syncEnvelopes( core::RULE_FUZZY );
+    double T, m;
+    core::blockBound( core::RULE_FUZZY, module, x, 1.0, 1, T, m );
+    expect_true( T < core::activation( core::RULE_FUZZY, module, x, module.weight( 0 ) ) );
+    expect_true( m >= module.rho );
+
+    core::Stats stats( 1 );
+    net.stats = &stats;
+    expect_true( core::ART::classify( net, 0, x ) == 0 );
+    expect_true( stats.modules[0].blocksVisited == 1 );
+    expect_true( stats.modules[0].blocksMatchPruned == 0 );
+    expect_true( stats.modules[0].blocksActivationPruned == 3 );
+  }
+
   test_that("weightUpdate"){
-    Fuzzy *f = new Fuzzy( List::create( 0 ) );
-    List module = List::create( _["alpha"] = 2 );
-    NumericVector x = NumericVector::create( 1,2,3 );
-    NumericVector w = NumericVector::create( 3,2,0 );
+    double x[] = { 1,2,3 };
+    double w[] = { 3,2,0 };
     double learningRate = 1.0;
-    NumericVector z = f->weightUpdate( module, learningRate, x, w );
-    NumericVector actual = NumericVector::create( 1,2,0 );
-    expect_true( equal( z, actual ) );
+    double change = core::fuzzy::weightUpdate( x, w, 3, learningRate );
+    expect_true( w[0] == 1 && w[1] == 2 && w[2] == 0 );
+    expect_true( change == 2 );
   }
 }
-
-
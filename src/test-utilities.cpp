@@ -84,6 +84,21 @@ context("utilities") {
     
   }
 
-}
-
+  test_that("linkClusters") {
+    IntegerVector edges = IntegerVector::create( 0,1, 3,4, 1,2, 4,0 );
+    List clusters = linkClusters( edges, seq( 0, 5 ) );
+    expect_true( clusters.length() == 2 );
+    IntegerVector c1 = clusters[0];
+    IntegerVector c2 = clusters[1];
+    expect_true( c1.length() == 5 );
+    expect_true( c2.length() == 1 );
+    expect_true( c2[0] == 5 );
+    
+    std::vector< int > index = clusterIndex( clusters, 6 );
+    for ( int i = 0; i < 5; i++ ){
+      expect_true( index[i] == 0 );
+    }
+    expect_true( index[5] == 1 );
+  }
 
+}
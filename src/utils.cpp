@@ -6,6 +6,8 @@
  ****************************************************************************/
 
 #include <Rcpp.h>
+#include "core.h"
+#include "native.h"
 using namespace Rcpp;
 
 
@@ -140,110 +142,27 @@ NumericVector vectorToMatrix( NumericVector v, int nrow, int ncol ){
 
 // [[Rcpp::export]]
 List linkClusters( IntegerVector edges, IntegerVector nodes ){
-  List g;
-  int nedges = edges.size();
-  for( int i = 0; i < nedges; i+=2 ){
-    if ( i == 0 ){
-      g.push_back( IntegerVector::create( edges( i ), edges( i+1 ) ) );
-    }
-    else{
-      int edge1 = -1;
-      int edge2 = -1;
-      std::vector< int > remove;
-      int len = g.length();
-      for ( int j = 0; j < len; j++ ){
-        IntegerVector v = g[j];
-        bool edge1Found = std::find( v.begin(), v.end(), edges( i ) ) != v.end();
-        bool edge2Found = std::find( v.begin(), v.end(), edges( i+1 ) ) != v.end();
-        if ( edge1Found && edge2Found ){
-          edge1 = j;
-          edge2 = j;
-        }
-        else if ( edge1Found && !edge2Found ){
-          edge1 = j;
-          // check if the second node is in another group
-          for ( int k = 0; k < len; k++ ){
-            if ( k != j ){
-              IntegerVector w = g[k];
-              if ( std::find( w.begin(), w.end(), edges( i+1 ) ) != w.end() ){
-                // if found, then push all the nodes in this vector into v
-                for ( int l : w ){
-                  v.push_back( l );
-                }
-                g[j] = v;
-                // remove this list index from g
-                remove.push_back( k );
-                edge2 = j;
-                break;
-              }
-            }
-          }
-        }
-        else if ( !edge1Found && edge2Found ){
-          edge2 = j;
-          // check if the first node is in another group
-          for ( int k = 0; k < len; k++ ){
-            if ( k != j ){
-              IntegerVector w = g[k];
-              if ( std::find( w.begin(), w.end(), edges( i+1 ) ) != w.end() ){
-                for ( int l : w ){
-                  v.push_back( l );
-                }
-                g[j] = v;
-                remove.push_back( k );
-                edge2 = j;
-                break;
-              }
-            }
-          }
-        }
-        if (edge1 > -1 && edge2 > -1)
-          break;
-
-      }
-      // both nodes are not in g, so add them as a separate group
-      if ( edge1 == -1 && edge2 == -1 ){
-        g.push_back( IntegerVector::create( edges( i ), edges( i+1 ) ) );
-      }
-      else if ( edge1 == -1 && edge2 > -1 ){
-        IntegerVector e = g[edge2];
-        e.push_back( edges( i ) );
-        g[edge2] = e;
-      }
-      else if ( edge1 > -1 && edge2 == -1 ){
-        IntegerVector e = g[edge1];
-        e.push_back( edges( i+1 ) );
-        g[edge1] = e;
-      }
-
-      if ( remove.size() > 0 ){
-        sort( remove.rbegin(), remove.rend() );
-        for ( int r : remove ){
-          g.erase( r );
-        }
-      }
-    }
+  std::vector< std::vector< int > > g = core::linkClusters( std::vector< int >( edges.begin(), edges.end() ),
+                                                            std::vector< int >( nodes.begin(), nodes.end() ) );
+  int glen = g.size();
+  List linked( glen );
+  for ( int i = 0; i < glen; i++ ){
+    linked[i] = wrap( g[i] );
   }
+  
+  return linked;
+}
 
-  // Add the nodes that are not linked into the linkedGroup
-
-  int len = nodes.length();
-  int glen = g.length();
-  for ( int i = 0; i < len; i++ ){
-    bool found = false;
-    for ( int j = 0; j < glen; j++ ){
-      IntegerVector v = g[j];
-      if ( std::find( v.begin(), v.end(), nodes( i ) ) != v.end() ){
-        found = true;
-        break;
-      }
-    }
-    if ( !found ){
-      g.push_back( nodes( i ) );
-    }
+// clusterIndex: map each node to the index of its linked cluster. Nodes that do not
+// belong to any cluster are mapped to -1.
+std::vector< int > clusterIndex( List linkedClusters, int numNodes ){
+  std::vector< std::vector< int > > clusters;
+  int l = linkedClusters.length();
+  for ( int i = 0; i < l; i++ ){
+    IntegerVector c = as<IntegerVector>( linkedClusters[i] );
+    clusters.push_back( std::vector< int >( c.begin(), c.end() ) );
   }
-
-  return g;
+  return core::clusterIndex( clusters, numNodes );
 }
 
 // [[Rcpp::export(.createDummyCodeMap)]]
@@ -303,6 +222,46 @@ StringVector decode (NumericMatrix dummyClasses, List dummyCode){
   return labels;
 }
 
+// [[Rcpp::export(.compact)]]
+List compact ( List net, int minCounter, Nullable< NumericMatrix > x = R_NilValue,
+               Nullable< NumericMatrix > target = R_NilValue, bool relearn = false, bool order = false ){
+  core::Network state = native::toNetwork( net );
+  std::vector< double > rows, labels;
+  core::Rows data, y;
+  if ( x.isNotNull() ){
+    NumericMatrix m( x );
+    rows = native::rowMajor( m );
+    data = core::Rows( rows.data(), m.nrow(), m.ncol() );
+  }
+  if ( target.isNotNull() ){
+    NumericMatrix m( target );
+    labels = native::rowMajor( m );
+    y = core::Rows( labels.data(), m.nrow(), m.ncol() );
+  }
+  core::CompactReport r = core::compact( state, minCounter, data, y, relearn, order );
+  
+  native::updateNetwork( state, net );
+  List orders( r.order.size() );
+  for ( size_t m = 0; m < r.order.size(); m++ ){
+    orders[m] = IntegerVector( r.order[m].begin(), r.order[m].end() );
+  }
+  List report = List::create( _["categories"] = r.categories,
+                              _["removed"] = r.removed,
+                              _["order"] = orders );
+  if ( r.measured ){
+    report.push_back( (double)r.orphans, "orphans" );
+    report.push_back( (double)r.relearned, "relearned" );
+    report.push_back( r.agreement, "agreement" );
+    report.push_back( r.timeBefore, "timeBefore" );
+    report.push_back( r.timeAfter, "timeAfter" );
+  }
+  if ( r.tested ){
+    report.push_back( r.accuracyBefore, "accuracyBefore" );
+    report.push_back( r.accuracyAfter, "accuracyAfter" );
+  }
+  return report;
+}
+
 // Check if two vectors are the same.
 bool equal( NumericVector x, NumericVector y ){
   if ( x.length() != y.length() ){
@@ -41,6 +41,9 @@ NumericVector vectorToMatrix( NumericVector v, int nrow, int ncol );
 // linkClusters: Linking Clusters (nodes that are linked together)
 List linkClusters( IntegerVector edges, IntegerVector nodes );
 
+// clusterIndex: map each node to the index of its linked cluster (-1 if not linked)
+std::vector< int > clusterIndex( List linkedClusters, int numNodes );
+
 // createDummyCodeMap: create dummy code for the class labels
 List createDummyCodeMap ( StringVector classLabels );
 